@@ -0,0 +1,298 @@
+#include <fstream>
+#include <opencv2/imgproc.hpp>
+
+#include "AnalysisCache.h"
+#include "Utilities.h"
+
+static char const cacheMagic[]{'R', 'P', 'D', 'A'};
+
+static uint32_t const cacheVersion = 4;
+
+template <typename T>
+static void writeValue(vector<uchar>& buffer, T const& value) {
+	auto const& bytes = reinterpret_cast<uchar const*>(&value);
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool readValue(uchar const*& data, uchar const* const& end, T& value) {
+	if (static_cast<size_t>(end - data) < sizeof(T))
+		return false;
+	memcpy(&value, data, sizeof(T));
+	data += sizeof(T);
+	return true;
+}
+
+static void writeEllipse(vector<uchar>& buffer, RotatedRect const& ellipse) {
+	writeValue(buffer, ellipse.center);
+	writeValue(buffer, ellipse.size);
+	writeValue(buffer, ellipse.angle);
+}
+
+static bool readEllipse(uchar const*& data, uchar const* const& end, RotatedRect& ellipse) { return readValue(data, end, ellipse.center) && readValue(data, end, ellipse.size) && readValue(data, end, ellipse.angle); }
+
+static void writeLayer(vector<uchar>& buffer, RunLengthLayer const& layer) {
+	auto const& runs = layer.getRuns();
+	writeValue(buffer, static_cast<int32_t>(layer.getSize().height));
+	writeValue(buffer, static_cast<int32_t>(layer.getSize().width));
+	writeValue(buffer, static_cast<uint32_t>(runs.size()));
+	for (auto run = runs.begin(); run < runs.end(); ++run) {
+		writeValue(buffer, run->first);
+		writeValue(buffer, run->second);
+	}
+}
+
+static bool readLayer(uchar const*& data, uchar const* const& end, RunLengthLayer& layer) {
+	int32_t rows, cols;
+	uint32_t nRuns;
+	if (!readValue(data, end, rows) || !readValue(data, end, cols) || rows < 0 || cols < 0 || !readValue(data, end, nRuns) || nRuns > static_cast<size_t>(end - data) / (sizeof(uchar) + sizeof(uint32_t)))
+		return false;
+	auto const& nPixels = static_cast<size_t>(rows) * cols;
+	vector<pair<uchar, uint32_t>> runs(nRuns);
+	size_t offset = 0;
+	for (auto run = runs.begin(); run < runs.end(); ++run) {
+		if (!readValue(data, end, run->first) || !readValue(data, end, run->second) || run->second > nPixels - offset)
+			return false;
+		offset += run->second;
+	}
+	if (offset != nPixels)
+		return false;
+	layer = RunLengthLayer(Size(cols, rows), runs);
+	return true;
+}
+
+AnalysisCache::AnalysisCache(size_t const& capacity) : capacity_(capacity) {}
+
+bool AnalysisCache::analyzeBaseImage(DesignContext& context, Mat const& base, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones], Mat (*const& designImages)[2], Mat* const& baseImage) {
+	Entry entry;
+	if (!getEntry(base, entry, context.segmentationBackend, baseImage))
+		return false;
+	extract(context, entry, remediedTeeth, remediedDesignImages, teeth, designImages);
+	return true;
+}
+
+bool AnalysisCache::analyzeBakedImage(DesignContext& context, uchar const* const& data, size_t const& size, uint64_t const& sourceHash, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones], Mat (*const& designImages)[2]) {
+	auto thisData = data;
+	auto const& end = data + size;
+	uint64_t hash, thisSourceHash;
+	Entry entry;
+	if (context.segmentationBackend != CONTOUR_TREE || !readValue(thisData, end, hash) || !readValue(thisData, end, thisSourceHash) || thisSourceHash != sourceHash)
+		return false;
+	if (!find(hash, entry)) {
+		if (!deserialize(thisData, end, entry))
+			return false;
+		insert(hash, entry);
+	}
+	extract(context, entry, remediedTeeth, remediedDesignImages, teeth, designImages);
+	return true;
+}
+
+bool AnalysisCache::bake(Mat const& base, uint64_t const& sourceHash, vector<uchar>& buffer) {
+	Entry entry;
+	if (!getEntry(base, entry))
+		return false;
+	buffer.clear();
+	writeValue(buffer, hashImage(base));
+	writeValue(buffer, sourceHash);
+	serialize(entry, buffer);
+	return true;
+}
+
+void AnalysisCache::setDirectory(string const& directory) {
+	lock_guard<mutex> lock(mutex_);
+	directory_ = directory;
+	if (directory_.size() && directory_.back() != '/' && directory_.back() != '\\')
+		directory_ += '/';
+}
+
+uint64_t AnalysisCache::hashBytes(uchar const* const& data, size_t const& size, uint64_t const& seed) {
+	auto hash = seed;
+	for (size_t i = 0; i < size; ++i)
+		(hash ^= data[i]) *= 1099511628211ULL;
+	return hash;
+}
+
+uint64_t AnalysisCache::hashImage(Mat const& image, SegmentationBackend const& backend) {
+	int const header[]{image.rows, image.cols, image.type(), backend};
+	auto hash = hashBytes(reinterpret_cast<uchar const*>(header), sizeof header);
+	auto const& rowSize = image.cols * image.elemSize();
+	for (auto row = 0; row < image.rows; ++row)
+		hash = hashBytes(image.ptr(row), rowSize, hash);
+	return hash;
+}
+
+bool AnalysisCache::find(uint64_t const& hash, Entry& entry) {
+	{
+		lock_guard<mutex> lock(mutex_);
+		auto const& it = entries_.find(hash);
+		if (it != entries_.end()) {
+			it->second.lastUsed = ++clock_;
+			entry = it->second;
+			return true;
+		}
+	}
+	if (!load(hash, entry))
+		return false;
+	insert(hash, entry);
+	return true;
+}
+
+bool AnalysisCache::getEntry(Mat const& base, Entry& entry, SegmentationBackend const& backend, Mat* const& baseImage) {
+	auto const& hash = hashImage(base, backend);
+	if (find(hash, entry)) {
+		if (baseImage)
+			copyMakeBorder(base, *baseImage, baseImageBorder, baseImageBorder, baseImageBorder, baseImageBorder, BORDER_CONSTANT, Scalar::all(255));
+	}
+	else {
+		DesignContext context;
+		Mat designImages[2], remediedDesignImages[2];
+		context.segmentationBackend = backend;
+		if (!::analyzeBaseImage(context, base, entry.remediedTeeth, remediedDesignImages, &entry.teeth, &designImages, baseImage))
+			return false;
+		entry.teethEllipse = context.teethEllipse;
+		entry.remediedTeethEllipse = context.remediedTeethEllipse;
+		entry.outlineLayer = RunLengthLayer(designImages[0]);
+		entry.remediedOutlineLayer = RunLengthLayer(remediedDesignImages[0]);
+		insert(hash, entry);
+		save(hash, entry);
+	}
+	return true;
+}
+
+void AnalysisCache::insert(uint64_t const& hash, Entry const& entry) {
+	lock_guard<mutex> lock(mutex_);
+	if (entries_.size() >= capacity_ && !entries_.count(hash)) {
+		auto oldest = entries_.begin();
+		for (auto it = entries_.begin(); it != entries_.end(); ++it)
+			if (it->second.lastUsed < oldest->second.lastUsed)
+				oldest = it;
+		entries_.erase(oldest);
+	}
+	auto& thisEntry = entries_[hash] = entry;
+	thisEntry.lastUsed = ++clock_;
+}
+
+bool AnalysisCache::load(uint64_t const& hash, Entry& entry) const {
+	auto const& path = getPath(hash);
+	if (path.empty())
+		return false;
+	ifstream file(path, ios::binary);
+	if (!file)
+		return false;
+	vector<uchar> buffer((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	return deserialize(buffer.data(), buffer.data() + buffer.size(), entry);
+}
+
+void AnalysisCache::save(uint64_t const& hash, Entry const& entry) const {
+	auto const& path = getPath(hash);
+	if (path.empty())
+		return;
+	vector<uchar> buffer;
+	serialize(entry, buffer);
+	auto const& tmpPath = path + ".tmp";
+	{
+		ofstream file(tmpPath, ios::binary | ios::trunc);
+		if (!file.write(reinterpret_cast<char const*>(buffer.data()), buffer.size()))
+			return;
+	}
+	remove(path.c_str());
+	rename(tmpPath.c_str(), path.c_str());
+}
+
+string AnalysisCache::getPath(uint64_t const& hash) const {
+	lock_guard<mutex> lock(mutex_);
+	if (directory_.empty())
+		return string();
+	char name[17];
+	snprintf(name, sizeof name, "%016llx", static_cast<unsigned long long>(hash));
+	return directory_ + name + ".rpda";
+}
+
+void AnalysisCache::serialize(Entry const& entry, vector<uchar>& buffer) {
+	buffer.insert(buffer.end(), begin(cacheMagic), end(cacheMagic));
+	writeValue(buffer, cacheVersion);
+	writeEllipse(buffer, entry.teethEllipse);
+	writeEllipse(buffer, entry.remediedTeethEllipse);
+	const vector<Tooth> (*const toothSets[])[nZones]{&entry.teeth, &entry.remediedTeeth};
+	for (auto i = 0; i < 2; ++i)
+		for (auto zone = 0; zone < nZones; ++zone) {
+			auto const& teethZone = (*toothSets[i])[zone];
+			writeValue(buffer, static_cast<uint32_t>(teethZone.size()));
+			for (auto tooth = teethZone.begin(); tooth < teethZone.end(); ++tooth) {
+				writeValue(buffer, tooth->radius_);
+				writeValue(buffer, tooth->centroid_);
+				writeValue(buffer, tooth->normalDirection_);
+				writeValue(buffer, static_cast<int8_t>(tooth->sweepSign_));
+				tooth->updateContour();
+				writeValue(buffer, static_cast<uint32_t>(tooth->contour_.size()));
+				for (auto point = tooth->contour_.begin(); point < tooth->contour_.end(); ++point)
+					writeValue(buffer, *point);
+				auto const& nAnglePoints = tooth->sweepSign_ ? tooth->nAnglePoints_ : 0;
+				writeValue(buffer, static_cast<int32_t>(nAnglePoints));
+				for (auto order = 0; order < nAnglePoints; ++order) {
+					auto const& angle = tooth->sweepSign_ == 1 ? order : 359 - order;
+					writeValue(buffer, static_cast<int32_t>(tooth->anglePointSegments_[angle]));
+					writeValue(buffer, tooth->anglePointParams_[angle]);
+					writeValue(buffer, tooth->anglePoints_[angle]);
+				}
+			}
+		}
+	writeLayer(buffer, entry.outlineLayer);
+	writeLayer(buffer, entry.remediedOutlineLayer);
+}
+
+bool AnalysisCache::deserialize(uchar const* data, uchar const* const& end, Entry& entry) {
+	uint32_t version;
+	if (static_cast<size_t>(end - data) < sizeof cacheMagic || !equal(begin(cacheMagic), std::end(cacheMagic), data))
+		return false;
+	data += sizeof cacheMagic;
+	if (!readValue(data, end, version) || version != cacheVersion || !readEllipse(data, end, entry.teethEllipse) || !readEllipse(data, end, entry.remediedTeethEllipse))
+		return false;
+	vector<Tooth> (*const toothSets[])[nZones]{&entry.teeth, &entry.remediedTeeth};
+	for (auto i = 0; i < 2; ++i)
+		for (auto zone = 0; zone < nZones; ++zone) {
+			auto& teethZone = (*toothSets[i])[zone];
+			uint32_t nTeeth;
+			if (!readValue(data, end, nTeeth) || nTeeth != nTeethPerZone)
+				return false;
+			teethZone.clear();
+			for (uint32_t ordinal = 0; ordinal < nTeeth; ++ordinal) {
+				Tooth tooth((vector<Point>()));
+				int8_t sweepSign;
+				uint32_t nPoints;
+				int32_t nAnglePoints;
+				if (!readValue(data, end, tooth.radius_) || !readValue(data, end, tooth.centroid_) || !readValue(data, end, tooth.normalDirection_) || !readValue(data, end, sweepSign) || sweepSign < -1 || sweepSign > 1)
+					return false;
+				if (!readValue(data, end, nPoints) || nPoints > static_cast<size_t>(end - data) / sizeof(Point))
+					return false;
+				tooth.contour_.resize(nPoints);
+				for (auto point = tooth.contour_.begin(); point < tooth.contour_.end(); ++point)
+					readValue(data, end, *point);
+				if (!readValue(data, end, nAnglePoints) || nAnglePoints < 0 || nAnglePoints > (sweepSign ? 360 : 0))
+					return false;
+				if (sweepSign)
+					tooth.findAnglePoints(sweepSign == 1 ? 0 : 1);
+				for (auto order = 0; order < nAnglePoints; ++order) {
+					auto const& angle = sweepSign == 1 ? order : 359 - order;
+					int32_t segment;
+					if (!readValue(data, end, segment) || segment < 0 || segment >= static_cast<int>(nPoints) || !readValue(data, end, tooth.anglePointParams_[angle]) || !readValue(data, end, tooth.anglePoints_[angle]))
+						return false;
+					tooth.anglePointSegments_[angle] = segment;
+				}
+				tooth.nAnglePoints_ = nAnglePoints;
+				teethZone.push_back(tooth);
+			}
+		}
+	return readLayer(data, end, entry.outlineLayer) && readLayer(data, end, entry.remediedOutlineLayer) && data == end;
+}
+
+void AnalysisCache::extract(DesignContext& context, Entry const& entry, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones], Mat (*const& designImages)[2]) {
+	context.teethEllipse = entry.teethEllipse;
+	context.remediedTeethEllipse = entry.remediedTeethEllipse;
+	copy(begin(entry.remediedTeeth), end(entry.remediedTeeth), remediedTeeth);
+	entry.remediedOutlineLayer.unpack(remediedDesignImages[0]);
+	if (teeth)
+		copy(begin(entry.teeth), end(entry.teeth), *teeth);
+	if (designImages)
+		entry.outlineLayer.unpack((*designImages)[0]);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <mutex>
+#include <opencv2/core/mat.hpp>
+
+#include "RunLengthLayer.h"
+#include "Tooth.h"
+
+class AnalysisCache {
+public:
+	explicit AnalysisCache(size_t const& capacity = 8);
+	bool analyzeBaseImage(DesignContext& context, Mat const& base, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones] = nullptr, Mat (*const& designImages)[2] = nullptr, Mat* const& baseImage = nullptr);
+	bool analyzeBakedImage(DesignContext& context, uchar const* const& data, size_t const& size, uint64_t const& sourceHash, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones] = nullptr, Mat (*const& designImages)[2] = nullptr);
+	bool bake(Mat const& base, uint64_t const& sourceHash, vector<uchar>& buffer);
+	void setDirectory(string const& directory);
+	static uint64_t hashBytes(uchar const* const& data, size_t const& size, uint64_t const& seed = 14695981039346656037ULL);
+	static uint64_t hashImage(Mat const& image, SegmentationBackend const& backend = CONTOUR_TREE);
+private:
+	struct Entry {
+		RotatedRect teethEllipse, remediedTeethEllipse;
+		vector<Tooth> teeth[nZones], remediedTeeth[nZones];
+		RunLengthLayer outlineLayer, remediedOutlineLayer;
+		uint64_t lastUsed = 0;
+	};
+
+	bool find(uint64_t const& hash, Entry& entry);
+	bool getEntry(Mat const& base, Entry& entry, SegmentationBackend const& backend = CONTOUR_TREE, Mat* const& baseImage = nullptr);
+	void insert(uint64_t const& hash, Entry const& entry);
+	bool load(uint64_t const& hash, Entry& entry) const;
+	void save(uint64_t const& hash, Entry const& entry) const;
+	string getPath(uint64_t const& hash) const;
+	static void serialize(Entry const& entry, vector<uchar>& buffer);
+	static bool deserialize(uchar const* data, uchar const* const& end, Entry& entry);
+	static void extract(DesignContext& context, Entry const& entry, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones], Mat (*const& designImages)[2]);
+	size_t capacity_;
+	uint64_t clock_ = 0;
+	map<uint64_t, Entry> entries_;
+	mutable mutex mutex_;
+	string directory_;
+};
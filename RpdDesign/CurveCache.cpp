@@ -0,0 +1,28 @@
+#include <opencv2/imgproc.hpp>
+
+#include "CurveCache.h"
+
+vector<float> CurveCache::getKey(Function const& function, vector<Rpd::Position> const& positions, vector<float> const& values, const vector<Point>* const& points) {
+	vector<float> key{static_cast<float>(function)};
+	for (auto position = positions.begin(); position < positions.end(); ++position) {
+		key.push_back(position->zone);
+		key.push_back(position->ordinal);
+	}
+	key.insert(key.end(), values.begin(), values.end());
+	key.push_back(points != nullptr);
+	if (points)
+		for (auto point = points->begin(); point < points->end(); ++point) {
+			key.push_back(point->x);
+			key.push_back(point->y);
+		}
+	return key;
+}
+
+CurveCache::Entry const* CurveCache::find(vector<float> const& key) const {
+	auto const& entry = entries_.find(key);
+	return entry == entries_.end() ? nullptr : &entry->second;
+}
+
+void CurveCache::insert(vector<float> const& key, Entry const& entry) { entries_[key] = entry; }
+
+void CurveCache::clear() { entries_.clear(); }
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Rpd.h"
+
+class CurveCache {
+public:
+	enum Function {
+		INNER_CURVE,
+		LINGUAL_CURVE,
+		OUTER_CURVE,
+		STRING_CURVES
+	};
+
+	struct Entry {
+		float value = 0;
+		int count = 0;
+		vector<Point> curve, points;
+		vector<vector<Point>> curves;
+	};
+
+	static vector<float> getKey(Function const& function, vector<Rpd::Position> const& positions, vector<float> const& values = {}, const vector<Point>* const& points = nullptr);
+	Entry const* find(vector<float> const& key) const;
+	void insert(vector<float> const& key, Entry const& entry);
+	void clear();
+private:
+	map<vector<float>, Entry> entries_;
+};
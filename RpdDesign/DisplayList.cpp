@@ -0,0 +1,200 @@
+#include <sstream>
+#include <opencv2/imgproc.hpp>
+
+#include "DisplayList.h"
+#include "Utilities.h"
+
+void DisplayList::addEllipse(Point2f const& center, Size2f const& axes, float const& angle, float const& startAngle, float const& endAngle, int const& level) {
+	auto const& radius = max(axes.width, axes.height);
+	Command command{ELLIPSE, false, 0, level, points_.size(), 1, 0, {axes.width, axes.height, angle, startAngle, endAngle}, Rect2f(center.x - radius, center.y - radius, radius * 2, radius * 2)};
+	points_.push_back(center);
+	commands_.push_back(command);
+}
+
+void DisplayList::addFill(vector<Point> const& curve, uchar const& color) {
+	Command command{FILL, true, color, 0, points_.size(), curve.size(), 0, {}, boundingRect(curve)};
+	appendPoints(curve);
+	commands_.push_back(command);
+}
+
+void DisplayList::addLayer(vector<Point> const& curve, uchar const& color, const vector<Point>* const& hole) {
+	Command command{LAYER, true, color, 2, points_.size(), curve.size(), hole ? hole->size() : 0, {}, boundingRect(curve)};
+	appendPoints(curve);
+	if (hole) {
+		appendPoints(*hole);
+		command.bounds |= static_cast<Rect2f>(boundingRect(*hole));
+	}
+	commands_.push_back(command);
+}
+
+void DisplayList::addLine(Point2f const& p1, Point2f const& p2, int const& level) {
+	Command command{LINE, false, 0, level, points_.size(), 2, 0, {}, Rect2f(p1, p2)};
+	points_.push_back(p1);
+	points_.push_back(p2);
+	commands_.push_back(command);
+}
+
+void DisplayList::addPolyline(vector<Point> const& curve, bool const& isClosed, int const& level) {
+	Command command{POLYLINE, isClosed, 0, level, points_.size(), curve.size(), 0, {}, boundingRect(curve)};
+	appendPoints(curve);
+	commands_.push_back(command);
+}
+
+void DisplayList::clear() {
+	commands_.clear();
+	points_.clear();
+}
+
+bool DisplayList::empty() const { return commands_.empty(); }
+
+void DisplayList::replay(Mat const& image, float const& scale, Point const& offset, Size const& canvasSize) const {
+	Rect const window(-offset, image.size());
+	auto const& canvasRect = canvasSize.area() ? Rect(Point(), canvasSize) : window;
+	thread_local Mat buffer;
+	for (auto command = commands_.begin(); command < commands_.end(); ++command) {
+		auto const& rect = getBounds(*command, scale) & canvasRect;
+		auto const& overlap = rect & window;
+		if (!overlap.area())
+			continue;
+		if (overlap == rect) {
+			draw(*command, image, scale, offset);
+			continue;
+		}
+		if (buffer.rows < rect.height || buffer.cols < rect.width)
+			buffer.create(max(buffer.rows, rect.height), max(buffer.cols, rect.width), CV_8U);
+		auto region = buffer(Rect(Point(), rect.size()));
+		region.setTo(255);
+		image(overlap + offset).copyTo(region(overlap - rect.tl()));
+		draw(*command, region, scale, -rect.tl());
+		region(overlap - rect.tl()).copyTo(image(overlap + offset));
+	}
+}
+
+string DisplayList::toSvg(Size const& size) const {
+	ostringstream stream;
+	stream << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << size.width << "\" height=\"" << size.height << "\" viewBox=\"0 0 " << size.width << ' ' << size.height << "\">";
+	stream << "<rect width=\"100%\" height=\"100%\" fill=\"#fff\"/>";
+	stream << "<g fill=\"none\" stroke=\"#000\" stroke-linecap=\"round\" stroke-linejoin=\"round\">";
+	for (auto command = commands_.begin(); command < commands_.end(); ++command) {
+		auto const& thickness = lineThicknessOfLevel[command->level];
+		switch (command->type) {
+		case ELLIPSE: {
+			auto const& values = command->values;
+			auto const& center = points_[command->first];
+			auto const& angle = degreeToRadian(values[2]);
+			auto const& startAngle = degreeToRadian(values[3]);
+			auto const& endAngle = degreeToRadian(values[4]);
+			auto const& start = center + rotate(Point2f(values[0] * cos(startAngle), values[1] * sin(startAngle)), angle);
+			auto const& end = center + rotate(Point2f(values[0] * cos(endAngle), values[1] * sin(endAngle)), angle);
+			stream << "<path d=\"M" << start.x << ' ' << start.y << 'A' << values[0] << ' ' << values[1] << ' ' << values[2] << ' ' << (values[4] - values[3] > 180) << " 1 " << end.x << ' ' << end.y << "\" stroke-width=\"" << thickness << "\"/>";
+			break;
+		}
+		case FILL:
+			stream << "<polygon points=\"";
+			writeSvgPoints(stream, command->first, command->count);
+			stream << "\" fill=\"rgb(" << +command->color << ',' << +command->color << ',' << +command->color << ")\" stroke=\"none\"/>";
+			break;
+		case LAYER:
+			stream << "<path d=\"M";
+			writeSvgPoints(stream, command->first, command->count);
+			stream << 'Z';
+			if (command->holeCount) {
+				stream << 'M';
+				writeSvgPoints(stream, command->first + command->count, command->holeCount);
+				stream << 'Z';
+			}
+			stream << "\" fill=\"rgb(" << +command->color << ',' << +command->color << ',' << +command->color << ")\" fill-rule=\"evenodd\" stroke=\"none\" style=\"mix-blend-mode:darken\"/>";
+			if (command->holeCount) {
+				stream << "<polygon points=\"";
+				writeSvgPoints(stream, command->first + command->count, command->holeCount);
+				stream << "\" stroke-width=\"" << thickness << "\"/>";
+			}
+			break;
+		case LINE:
+			stream << "<line x1=\"" << points_[command->first].x << "\" y1=\"" << points_[command->first].y << "\" x2=\"" << points_[command->first + 1].x << "\" y2=\"" << points_[command->first + 1].y << "\" stroke-width=\"" << thickness << "\"/>";
+			break;
+		case POLYLINE:
+			stream << '<' << (command->isClosed ? "polygon" : "polyline") << " points=\"";
+			writeSvgPoints(stream, command->first, command->count);
+			stream << "\" stroke-width=\"" << thickness << "\"/>";
+			break;
+		}
+	}
+	stream << "</g></svg>";
+	return stream.str();
+}
+
+void DisplayList::appendPoints(vector<Point> const& curve) {
+	for (auto point = curve.begin(); point < curve.end(); ++point)
+		points_.push_back(*point);
+}
+
+void DisplayList::draw(Command const& command, Mat const& image, float const& scale, Point const& offset) const {
+	auto const& thickness = getThickness(command.level, scale);
+	thread_local vector<Point> points, hole;
+	switch (command.type) {
+	case ELLIPSE: {
+		auto const& values = command.values;
+		ellipse(image, static_cast<Point>(points_[command.first] * scale) + offset, Size(values[0] * scale, values[1] * scale), values[2], values[3], values[4], 0, thickness, LINE_AA);
+		break;
+	}
+	case FILL:
+		transformPoints(command, scale, offset, points);
+		fillCurve(image, points, command.color);
+		break;
+	case LAYER: {
+		transformPoints(command, scale, offset, points, &hole);
+		auto rect = boundingRect(points);
+		if (!hole.empty())
+			rect |= boundingRect(hole);
+		auto const& roi = Rect(rect.x - thickness, rect.y - thickness, rect.width + thickness * 2, rect.height + thickness * 2) & Rect(Point(), image.size());
+		if (!roi.area())
+			break;
+		auto const& layer = getLayer(roi.size());
+		fillCurve(layer, points, command.color, -roi.tl());
+		if (!hole.empty()) {
+			fillCurve(layer, hole, 255, -roi.tl());
+			for (auto point = hole.begin(); point < hole.end(); ++point)
+				*point -= roi.tl();
+			polylines(layer, hole, true, 0, thickness, LINE_AA);
+		}
+		bitwise_and(layer, image(roi), image(roi));
+		break;
+	}
+	case LINE:
+		transformPoints(command, scale, offset, points);
+		line(image, points[0], points[1], 0, thickness, LINE_AA);
+		break;
+	case POLYLINE:
+		transformPoints(command, scale, offset, points);
+		polylines(image, points, command.isClosed, 0, thickness, LINE_AA);
+		break;
+	}
+}
+
+Rect DisplayList::getBounds(Command const& command, float const& scale) const {
+	auto const& margin = getThickness(command.level, scale) + 2;
+	auto const& bounds = command.bounds;
+	return Rect(Point(cvFloor(bounds.x * scale) - margin, cvFloor(bounds.y * scale) - margin), Point(cvCeil(bounds.br().x * scale) + margin + 1, cvCeil(bounds.br().y * scale) + margin + 1));
+}
+
+int DisplayList::getThickness(int const& level, float const& scale) const { return max(cvRound(lineThicknessOfLevel[level] * scale), 1); }
+
+void DisplayList::transformPoints(Command const& command, float const& scale, Point const& offset, vector<Point>& points, vector<Point>* const& hole) const {
+	points.resize(command.count);
+	for (auto i = 0; i < command.count; ++i)
+		points[i] = static_cast<Point>(points_[command.first + i] * scale) + offset;
+	if (hole) {
+		hole->resize(command.holeCount);
+		for (auto i = 0; i < command.holeCount; ++i)
+			(*hole)[i] = static_cast<Point>(points_[command.first + command.count + i] * scale) + offset;
+	}
+}
+
+void DisplayList::writeSvgPoints(ostream& stream, size_t const& first, size_t const& count) const {
+	for (auto i = first; i < first + count; ++i) {
+		if (i > first)
+			stream << ' ';
+		stream << points_[i].x << ',' << points_[i].y;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ostream>
+
+#include "Rpd.h"
+
+class DisplayList {
+public:
+	void addEllipse(Point2f const& center, Size2f const& axes, float const& angle, float const& startAngle, float const& endAngle, int const& level);
+	void addFill(vector<Point> const& curve, uchar const& color);
+	void addLayer(vector<Point> const& curve, uchar const& color, const vector<Point>* const& hole = nullptr);
+	void addLine(Point2f const& p1, Point2f const& p2, int const& level);
+	void addPolyline(vector<Point> const& curve, bool const& isClosed, int const& level);
+	void clear();
+	bool empty() const;
+	void replay(Mat const& image, float const& scale = 1, Point const& offset = Point(), Size const& canvasSize = Size()) const;
+	string toSvg(Size const& size) const;
+private:
+	enum Type {
+		ELLIPSE,
+		FILL,
+		LAYER,
+		LINE,
+		POLYLINE
+	};
+
+	struct Command {
+		Type type;
+		bool isClosed;
+		uchar color;
+		int level;
+		size_t first, count, holeCount;
+		float values[5];
+		Rect2f bounds;
+	};
+
+	void appendPoints(vector<Point> const& curve);
+	void draw(Command const& command, Mat const& image, float const& scale, Point const& offset) const;
+	Rect getBounds(Command const& command, float const& scale) const;
+	int getThickness(int const& level, float const& scale) const;
+	void writeSvgPoints(ostream& stream, size_t const& first, size_t const& count) const;
+	void transformPoints(Command const& command, float const& scale, Point const& offset, vector<Point>& points, vector<Point>* const& hole = nullptr) const;
+	vector<Command> commands_;
+	vector<Point2f> points_;
+};
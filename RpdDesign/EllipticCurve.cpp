@@ -7,11 +7,15 @@ EllipticCurve::EllipticCurve(Point2f const& center, Size const& axes, float cons
 
 EllipticCurve::EllipticCurve(Point2f const& center, Size const& axes, float const& inclination, float const& startAngle, float const& endAngle, bool const& shouldReverse) : shouldReverse_(shouldReverse), endAngle_(endAngle), inclination_(inclination), startAngle_(startAngle), center_(center), axes_(axes) {}
 
-bool EllipticCurve::getCurve(vector<Point>& curve) const {
+bool EllipticCurve::getCurve(DesignContext const& context, vector<Point>& curve) const {
 	auto const& radius = axes_.width;
-	if (radius <= 0 || radius > sqrt((remedyImage ? remediedTeethEllipse : teethEllipse).size.area() / 2) && abs(endAngle_ - startAngle_) < 5)
+	if (radius <= 0 || radius > sqrt(context.getTeethEllipse().size.area() / 2) && abs(endAngle_ - startAngle_) < 5)
 		return false;
-	ellipse2Poly(center_, axes_, inclination_, startAngle_, endAngle_, 1, curve);
+	auto const& maxRadius = max(axes_.width, axes_.height);
+	auto delta = 90;
+	if (context.arcTolerance < maxRadius)
+		delta = min(max(static_cast<int>(radianToDegree(2 * acos(1 - context.arcTolerance / maxRadius))), 1), delta);
+	ellipse2Poly(center_, axes_, inclination_, startAngle_, endAngle_, delta, curve);
 	if (shouldReverse_)
 		reverse(curve.begin(), curve.end());
 	return true;
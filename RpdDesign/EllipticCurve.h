@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include "GlobalVariables.h"
+
 using namespace std;
 using namespace cv;
 
@@ -7,7 +9,7 @@ class EllipticCurve {
 public:
 	EllipticCurve(Point2f const& center, Size const& axes, float const& inclination, float const& endAngle, bool const& shouldReverse);
 	EllipticCurve(Point2f const& center, Size const& axes, float const& inclination, float const& startAngle, float const& endAngle, bool const& shouldReverse);
-	bool getCurve(vector<Point>& curve) const;
+	bool getCurve(DesignContext const& context, vector<Point>& curve) const;
 private:
 	bool shouldReverse_;
 	float endAngle_, inclination_, startAngle_;
@@ -1,9 +1,3 @@
-﻿#include <opencv2/core/types.hpp>
+﻿#include "GlobalVariables.h"
 
-using namespace cv;
-
-bool remedyImage;
-
-RotatedRect teethEllipse;
-
-RotatedRect remediedTeethEllipse;
+RotatedRect const& DesignContext::getTeethEllipse() const { return remedyImage ? remediedTeethEllipse : teethEllipse; }
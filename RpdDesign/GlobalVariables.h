@@ -6,6 +6,10 @@
 using namespace std;
 using namespace cv;
 
+class CurveCache;
+class DisplayList;
+class TeethTopology;
+
 enum RpdClass {
 	AKERS_CLASP,
 	CANINE_AKERS_CLASP,
@@ -28,6 +32,17 @@ enum RpdClass {
 	WW_CLASP
 };
 
+enum ImageFormat {
+	PNG,
+	PGM,
+	QOI
+};
+
+enum SegmentationBackend {
+	CONTOUR_TREE,
+	CONNECTED_COMPONENTS
+};
+
 enum DistanceScaledCurve {
 	BYPASS,
 	DENTURE_BASE_CURVE,
@@ -42,6 +57,8 @@ const int lineThicknessOfLevel[]{2, 5, 8};
 
 int const nTeethPerZone = 8, nZones = 4;
 
+int const baseImageBorder = 80, maxSegmentationSide = 2048;
+
 map<string, RpdClass> const rpdMapping_ = {
 	{"aker_clasp", AKERS_CLASP},
 	{"canine_aker_clasp", CANINE_AKERS_CLASP},
@@ -66,8 +83,15 @@ map<string, RpdClass> const rpdMapping_ = {
 	{"wrought_wire_clasp", WW_CLASP}
 };
 
-extern bool remedyImage;
-
-extern RotatedRect teethEllipse;
-
-extern RotatedRect remediedTeethEllipse;
+struct DesignContext {
+	RotatedRect const& getTeethEllipse() const;
+	bool remedyImage = false;
+	bool isEighthUsed[nZones] = {};
+	bool renderInParallel = false;
+	float arcTolerance = 0.25F;
+	SegmentationBackend segmentationBackend = CONTOUR_TREE;
+	CurveCache* curveCache = nullptr;
+	DisplayList* displayList = nullptr;
+	TeethTopology const* topology = nullptr;
+	RotatedRect teethEllipse, remediedTeethEllipse;
+};
@@ -0,0 +1,109 @@
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "ImageEncoder.h"
+
+ImageEncoder::ImageEncoder(Size const& size, ImageFormat const& format, int const& level, vector<uchar>& buffer) : format_(format), level_(level), size_(size), buffer_(buffer) {
+	switch (format_) {
+	case PNG:
+		buffer_.clear();
+		break;
+	case PGM: {
+		auto const& header = "P5\n" + to_string(size.width) + ' ' + to_string(size.height) + "\n255\n";
+		buffer_.assign(header.begin(), header.end());
+		break;
+	}
+	case QOI:
+		buffer_.assign({'q', 'o', 'i', 'f'});
+		writeBigEndian(size.width);
+		writeBigEndian(size.height);
+		buffer_.push_back(3);
+		buffer_.push_back(0);
+		break;
+	}
+}
+
+void ImageEncoder::finish() {
+	switch (format_) {
+	case PNG:
+	case PGM:
+		break;
+	case QOI:
+		if (qoiRun_)
+			buffer_.push_back(0xc0 | qoiRun_ - 1);
+		buffer_.insert(buffer_.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+		break;
+	}
+}
+
+void ImageEncoder::write(Mat const& rows) {
+	switch (format_) {
+	case PNG:
+		CV_Assert(!nRows_ && rows.size() == size_);
+		imencode(".png", rows, buffer_, {IMWRITE_PNG_COMPRESSION, level_});
+		break;
+	case PGM: {
+		Mat grayRows;
+		if (rows.channels() == 1)
+			grayRows = rows;
+		else
+			cvtColor(rows, grayRows, COLOR_BGR2GRAY);
+		for (auto y = 0; y < grayRows.rows; ++y)
+			buffer_.insert(buffer_.end(), grayRows.ptr(y), grayRows.ptr(y) + grayRows.cols);
+		break;
+	}
+	case QOI:
+		writeQoi(rows);
+		break;
+	}
+	nRows_ += rows.rows;
+}
+
+void ImageEncoder::writeBigEndian(uint32_t const& value) {
+	for (auto shift = 24; shift >= 0; shift -= 8)
+		buffer_.push_back(value >> shift & 0xff);
+}
+
+void ImageEncoder::writeQoi(Mat const& rows) {
+	auto const& isGray = rows.channels() == 1;
+	for (auto y = 0; y < rows.rows; ++y)
+		for (auto x = 0; x < rows.cols; ++x) {
+			Vec3b pixel;
+			if (isGray)
+				pixel = Vec3b::all(rows.at<uchar>(y, x));
+			else {
+				auto const& bgr = rows.at<Vec3b>(y, x);
+				pixel = Vec3b(bgr[2], bgr[1], bgr[0]);
+			}
+			if (pixel == qoiPrevPixel_) {
+				if (++qoiRun_ == 62) {
+					buffer_.push_back(0xc0 | qoiRun_ - 1);
+					qoiRun_ = 0;
+				}
+				continue;
+			}
+			if (qoiRun_) {
+				buffer_.push_back(0xc0 | qoiRun_ - 1);
+				qoiRun_ = 0;
+			}
+			auto const& hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + 255 * 11) % 64;
+			if (isQoiIndexed_[hash] && qoiIndex_[hash] == pixel)
+				buffer_.push_back(hash);
+			else {
+				qoiIndex_[hash] = pixel;
+				isQoiIndexed_[hash] = true;
+				auto const& dr = static_cast<int8_t>(pixel[0] - qoiPrevPixel_[0]);
+				auto const& dg = static_cast<int8_t>(pixel[1] - qoiPrevPixel_[1]);
+				auto const& db = static_cast<int8_t>(pixel[2] - qoiPrevPixel_[2]);
+				if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+					buffer_.push_back(0x40 | dr + 2 << 4 | dg + 2 << 2 | db + 2);
+				else if (dg >= -32 && dg <= 31 && dr - dg >= -8 && dr - dg <= 7 && db - dg >= -8 && db - dg <= 7) {
+					buffer_.push_back(0x80 | dg + 32);
+					buffer_.push_back(dr - dg + 8 << 4 | db - dg + 8);
+				}
+				else
+					buffer_.insert(buffer_.end(), {0xfe, pixel[0], pixel[1], pixel[2]});
+			}
+			qoiPrevPixel_ = pixel;
+		}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <opencv2/core/mat.hpp>
+
+#include "GlobalVariables.h"
+
+class ImageEncoder {
+public:
+	ImageEncoder(Size const& size, ImageFormat const& format, int const& level, vector<uchar>& buffer);
+	void finish();
+	void write(Mat const& rows);
+private:
+	void writeBigEndian(uint32_t const& value);
+	void writeQoi(Mat const& rows);
+	ImageFormat format_;
+	int level_, nRows_ = 0;
+	Size size_;
+	vector<uchar>& buffer_;
+	Vec3b qoiIndex_[64], qoiPrevPixel_;
+	bool isQoiIndexed_[64] = {};
+	int qoiRun_ = 0;
+};
@@ -1,6 +1,7 @@
 #include <opencv2/imgproc.hpp>
 
 #include "Rpd.h"
+#include "TeethTopology.h"
 #include "Tooth.h"
 #include "Utilities.h"
 
@@ -43,6 +44,8 @@ Rpd::Position Rpd::Position::operator--(int) {
 
 Rpd::Rpd(vector<Position> const& positions) : positions_(positions) {}
 
+vector<Rpd::Position> const& Rpd::getPositions() const { return positions_; }
+
 void Rpd::queryPositions(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, vector<Position>& positions, bool (&isEighthToothUsed)[nZones], bool const& autoComplete) {
 	auto const& teeth = env->CallObjectMethod(individual, midListProperties, opComponentPosition);
 	auto count = 0;
@@ -113,11 +116,11 @@ RpdAsMajorConnector::RpdAsMajorConnector(vector<Position> const& positions, cons
 		copy(begin(hasLingualConfrontations[zone]), end(hasLingualConfrontations[zone]), hasLingualConfrontations_[zone]);
 }
 
-void RpdAsMajorConnector::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void RpdAsMajorConnector::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	vector<vector<Point>> curves;
 	computeLingualConfrontationCurves(teeth, positions_, curves);
 	for (auto curve = curves.begin(); curve < curves.end(); ++curve)
-		polylines(designImage, *curve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+		drawCurve(context, designImage, *curve, false, 2);
 
 }
 
@@ -164,19 +167,19 @@ RpdWithLingualClaspArms::RpdWithLingualClaspArms(vector<Position> const& positio
 
 RpdWithLingualClaspArms::RpdWithLingualClaspArms(vector<Position> const& positions, Material const& material, Direction const& rootDirection) : RpdWithLingualClaspArms(positions, material, vector<Direction>{rootDirection}) {}
 
-void RpdWithLingualClaspArms::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void RpdWithLingualClaspArms::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	for (auto i = 0; i < positions_.size(); ++i)
 		if (hasLingualArms_[i])
-			HalfClasp(positions_[i], material_, ~rootDirections_[i], LINGUAL).draw(designImage, teeth);
+			HalfClasp(positions_[i], material_, ~rootDirections_[i], LINGUAL).draw(context, designImage, teeth);
 }
 
 void RpdWithLingualClaspArms::registerLingualCoverage(vector<Tooth> (&teeth)[nZones]) const { RpdWithLingualCoverage::registerLingualCoverage(teeth, hasLingualArms_); }
 
 RpdWithLingualRest::RpdWithLingualRest(vector<Position> const& positions, Material const& material, Direction const& direction) : Rpd(positions), RpdWithClaspRootOrRest(positions, direction), RpdWithLingualCoverage(positions, material, direction) {}
 
-void RpdWithLingualRest::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void RpdWithLingualRest::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	for (auto i = 0; i < positions_.size(); ++i)
-		LingualRest(vector<Position>{positions_[i]}, material_, RpdWithLingualCoverage::rootDirections_[i]).draw(designImage, teeth);
+		LingualRest(vector<Position>{positions_[i]}, material_, RpdWithLingualCoverage::rootDirections_[i]).draw(context, designImage, teeth);
 }
 
 AkersClasp::AkersClasp(vector<Position> const& positions, Material const& material, Direction const& direction, bool const& enableBuccalArm, bool const& enableLingualArm, bool const& enableRest) : Rpd(positions), RpdWithDirection(direction), RpdWithClaspRootOrRest(positions, ~direction), RpdWithLingualClaspArms(positions, material, ~direction), enableBuccalArm_(enableBuccalArm), enableRest_(enableRest) { hasLingualArms_[0] = enableLingualArm; }
@@ -202,12 +205,12 @@ AkersClasp* AkersClasp::createFromIndividual(JNIEnv* const& env, jmethodID const
 	return new AkersClasp(positions, claspMaterial, claspTipDirection, enableBuccalArm, enableLingualArm, enableRest);
 }
 
-void AkersClasp::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	RpdWithLingualClaspArms::draw(designImage, teeth);
+void AkersClasp::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	RpdWithLingualClaspArms::draw(context, designImage, teeth);
 	if (enableRest_)
-		OcclusalRest(positions_, ~direction_).draw(designImage, teeth);
+		OcclusalRest(positions_, ~direction_).draw(context, designImage, teeth);
 	if (enableBuccalArm_)
-		HalfClasp(positions_, material_, direction_, BUCCAL).draw(designImage, teeth);
+		HalfClasp(positions_, material_, direction_, BUCCAL).draw(context, designImage, teeth);
 }
 
 void AkersClasp::setLingualClaspArms(vector<Tooth> (&teeth)[nZones]) {
@@ -227,9 +230,9 @@ CanineAkersClasp* CanineAkersClasp::createFromIndividual(JNIEnv* const& env, jme
 
 CanineAkersClasp::CanineAkersClasp(vector<Position> const& positions, Material const& claspMaterial, Direction const& direction) : Rpd(positions), RpdWithDirection(direction), RpdWithLingualRest(positions, WROUGHT_WIRE, ~direction), claspMaterial_(claspMaterial) {}
 
-void CanineAkersClasp::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	RpdWithLingualRest::draw(designImage, teeth);
-	HalfClasp(positions_, claspMaterial_, direction_, BUCCAL).draw(designImage, teeth);
+void CanineAkersClasp::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	RpdWithLingualRest::draw(context, designImage, teeth);
+	HalfClasp(positions_, claspMaterial_, direction_, BUCCAL).draw(context, designImage, teeth);
 }
 
 CombinationAnteriorPosteriorPalatalStrap* CombinationAnteriorPosteriorPalatalStrap::createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]) {
@@ -242,27 +245,23 @@ CombinationAnteriorPosteriorPalatalStrap* CombinationAnteriorPosteriorPalatalStr
 
 CombinationAnteriorPosteriorPalatalStrap::CombinationAnteriorPosteriorPalatalStrap(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]) : RpdAsMajorConnector(positions, hasLingualConfrontations) {}
 
-void CombinationAnteriorPosteriorPalatalStrap::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	RpdAsMajorConnector::draw(designImage, teeth);
+void CombinationAnteriorPosteriorPalatalStrap::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	RpdAsMajorConnector::draw(context, designImage, teeth);
 	vector<Point> curve, innerCurve, mesialCurve, distalCurve, tmpCurve, distalPoints(2);
 	vector<vector<Point>> curves;
-	computeLingualCurve(teeth, {positions_[2], positions_[3]}, tmpCurve, curves, distalPoints[1]);
+	computeLingualCurve(context, teeth, {positions_[2], positions_[3]}, tmpCurve, curves, distalPoints[1]);
 	curve.insert(curve.end(), tmpCurve.rbegin(), tmpCurve.rend());
-	computeMesialCurve(teeth, {positions_[2], positions_[0]}, mesialCurve, &innerCurve);
+	computeMesialCurve(context, teeth, {positions_[2], positions_[0]}, mesialCurve, &innerCurve);
 	curve.insert(curve.end(), mesialCurve.begin(), mesialCurve.end());
-	computeLingualCurve(teeth, {positions_[0], positions_[1]}, tmpCurve, curves, distalPoints[0]);
+	computeLingualCurve(context, teeth, {positions_[0], positions_[1]}, tmpCurve, curves, distalPoints[0]);
 	curve.insert(curve.end(), tmpCurve.begin(), tmpCurve.end());
-	computeDistalCurve(teeth, {positions_[1], positions_[3]}, distalPoints, distalCurve, &innerCurve);
+	computeDistalCurve(context, teeth, {positions_[1], positions_[3]}, distalPoints, distalCurve, &innerCurve);
 	curve.insert(curve.end(), distalCurve.begin(), distalCurve.end());
-	auto const& thisDesign = Mat(designImage.size(), CV_8U, 255);
-	fillPoly(thisDesign, vector<vector<Point>>{curve}, 128, LINE_AA);
-	fillPoly(thisDesign, vector<vector<Point>>{innerCurve}, 255, LINE_AA);
-	polylines(thisDesign, innerCurve, true, 0, lineThicknessOfLevel[2], LINE_AA);
-	bitwise_and(thisDesign, designImage, designImage);
+	drawLayer(context, designImage, curve, 128, &innerCurve);
 	for (auto thisCurve = curves.begin(); thisCurve < curves.end(); ++thisCurve)
-		polylines(designImage, *thisCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
-	polylines(designImage, mesialCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
-	polylines(designImage, distalCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+		drawCurve(context, designImage, *thisCurve, false, 2);
+	drawCurve(context, designImage, mesialCurve, false, 2);
+	drawCurve(context, designImage, distalCurve, false, 2);
 }
 
 CombinationClasp::CombinationClasp(vector<Position> const& positions, Direction const& direction) : Rpd(positions), RpdWithDirection(direction), RpdWithClaspRootOrRest(positions, ~direction), RpdWithLingualClaspArms(positions, CAST, ~direction) {}
@@ -275,10 +274,10 @@ CombinationClasp* CombinationClasp::createFromIndividual(JNIEnv* const& env, jme
 	return new CombinationClasp(positions, claspTipDirection);
 }
 
-void CombinationClasp::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	RpdWithLingualClaspArms::draw(designImage, teeth);
-	OcclusalRest(positions_, ~direction_).draw(designImage, teeth);
-	HalfClasp(positions_, WROUGHT_WIRE, direction_, BUCCAL).draw(designImage, teeth);
+void CombinationClasp::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	RpdWithLingualClaspArms::draw(context, designImage, teeth);
+	OcclusalRest(positions_, ~direction_).draw(context, designImage, teeth);
+	HalfClasp(positions_, WROUGHT_WIRE, direction_, BUCCAL).draw(context, designImage, teeth);
 }
 
 CombinedClasp::CombinedClasp(vector<Position> const& positions, Material const& material) : Rpd(positions), RpdWithClaspRootOrRest(positions, {positions[0].zone == positions[1].zone ? DISTAL : MESIAL, MESIAL}), RpdWithLingualClaspArms(positions, material, {positions[0].zone == positions[1].zone ? DISTAL : MESIAL, MESIAL}) {}
@@ -291,13 +290,13 @@ CombinedClasp* CombinedClasp::createFromIndividual(JNIEnv* const& env, jmethodID
 	return new CombinedClasp(positions, claspMaterial);
 }
 
-void CombinedClasp::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	RpdWithLingualClaspArms::draw(designImage, teeth);
+void CombinedClasp::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	RpdWithLingualClaspArms::draw(context, designImage, teeth);
 	auto isInSameZone = positions_[0].zone == positions_[1].zone;
-	OcclusalRest(positions_[0], isInSameZone ? DISTAL : MESIAL).draw(designImage, teeth);
-	OcclusalRest(positions_[1], MESIAL).draw(designImage, teeth);
-	HalfClasp(positions_[0], material_, isInSameZone ? MESIAL : DISTAL, BUCCAL).draw(designImage, teeth);
-	HalfClasp(positions_[1], material_, DISTAL, BUCCAL).draw(designImage, teeth);
+	OcclusalRest(positions_[0], isInSameZone ? DISTAL : MESIAL).draw(context, designImage, teeth);
+	OcclusalRest(positions_[1], MESIAL).draw(context, designImage, teeth);
+	HalfClasp(positions_[0], material_, isInSameZone ? MESIAL : DISTAL, BUCCAL).draw(context, designImage, teeth);
+	HalfClasp(positions_[1], material_, DISTAL, BUCCAL).draw(context, designImage, teeth);
 }
 
 ContinuousClasp* ContinuousClasp::createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midResourceGetProperty, jmethodID const& midStatementGetProperty, jobject const& dpClaspMaterial, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]) {
@@ -315,20 +314,26 @@ void ContinuousClasp::setLingualClaspArms(vector<Tooth> (&teeth)[nZones]) {
 
 ContinuousClasp::ContinuousClasp(vector<Position> const& positions, Material const& material) : Rpd(positions), RpdWithClaspRootOrRest(positions, {positions[0].zone == positions[1].zone ? MESIAL : DISTAL, DISTAL}), RpdWithLingualClaspArms(positions, material, {positions[0].zone == positions[1].zone ? MESIAL : DISTAL, DISTAL}) {}
 
-void ContinuousClasp::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void ContinuousClasp::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	auto const& isInSameZone = positions_[0].zone == positions_[1].zone;
-	OcclusalRest(positions_[0], isInSameZone ? MESIAL : DISTAL).draw(designImage, teeth);
-	OcclusalRest(positions_[1], DISTAL).draw(designImage, teeth);
+	OcclusalRest(positions_[0], isInSameZone ? MESIAL : DISTAL).draw(context, designImage, teeth);
+	OcclusalRest(positions_[1], DISTAL).draw(context, designImage, teeth);
 	auto const& hasLingualClaspArm = hasLingualArms_[0];
-	auto curve1 = getTooth(teeth, positions_[0]).getCurve(isInSameZone ? hasLingualClaspArm ? 180 : 0 : 60, isInSameZone ? 120 : hasLingualClaspArm ? 0 : 180), curve2 = getTooth(teeth, positions_[1]).getCurve(60, hasLingualClaspArm ? 0 : 180);
+	auto const &curve1 = getTooth(teeth, positions_[0]).getCurve(isInSameZone ? hasLingualClaspArm ? 180 : 0 : 60, isInSameZone ? 120 : hasLingualClaspArm ? 0 : 180), &curve2 = getTooth(teeth, positions_[1]).getCurve(60, hasLingualClaspArm ? 0 : 180);
 	if (hasLingualClaspArm) {
-		if (!isInSameZone)
-			reverse(curve1.begin(), curve1.end());
-		curve2.insert(curve2.end(), curve1.begin(), curve1.end());
+		vector<Point> curve;
+		curve.reserve(curve1.size() + curve2.size());
+		curve.insert(curve.end(), curve2.begin(), curve2.end());
+		if (isInSameZone)
+			curve.insert(curve.end(), curve1.begin(), curve1.end());
+		else
+			curve.insert(curve.end(), curve1.rbegin(), curve1.rend());
+		drawCurve(context, designImage, curve, false, 1 + (material_ == CAST));
+	}
+	else {
+		drawCurve(context, designImage, curve1, false, 1 + (material_ == CAST));
+		drawCurve(context, designImage, curve2, false, 1 + (material_ == CAST));
 	}
-	else
-		polylines(designImage, curve1, false, 0, lineThicknessOfLevel[1 + (material_ == CAST)], LINE_AA);
-	polylines(designImage, curve2, false, 0, lineThicknessOfLevel[1 + (material_ == CAST)], LINE_AA);
 }
 
 DentureBase::DentureBase(vector<Position> const& positions) : Rpd(positions) {}
@@ -339,34 +344,34 @@ DentureBase* DentureBase::createFromIndividual(JNIEnv* const& env, jmethodID con
 	return new DentureBase(positions);
 }
 
-void DentureBase::setSide(const vector<Tooth> (&teeth)[nZones]) {
+void DentureBase::setSide(DesignContext const& context, const vector<Tooth> (&teeth)[nZones]) {
 	auto isCoveringTail = false;
 	for (auto i = 0; i < 2; ++i)
-		if (isLastTooth(positions_[i])) {
+		if (isLastTooth(context, positions_[i])) {
 			isCoveringTail = true;
 			break;
 		}
-	side_ = !isCoveringTail && isBlockedByMajorConnector(teeth, positions_) ? SINGLE : DOUBLE;
+	side_ = !isCoveringTail && context.topology->isBlockedByMajorConnector(positions_) ? SINGLE : DOUBLE;
 }
 
 void DentureBase::registerDentureBase(vector<Tooth> (&teeth)[nZones]) const { registerDentureBase(teeth, positions_); }
 
 void DentureBase::registerExpectedAnchors(vector<Tooth> (&teeth)[nZones]) const { registerExpectedAnchors(teeth, positions_); }
 
-void DentureBase::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void DentureBase::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	if (side_ == DOUBLE) {
 		vector<vector<Point>> curves;
-		computeStringCurves(teeth, positions_, {distanceScales[DENTURE_BASE_CURVE], -distanceScales[DENTURE_BASE_CURVE]}, {true, true}, {true, true}, true, curves);
+		computeStringCurves(context, teeth, positions_, {distanceScales[DENTURE_BASE_CURVE], -distanceScales[DENTURE_BASE_CURVE]}, {true, true}, {true, true}, true, curves);
 		for (auto i = 0; i < 2; ++i)
-			computePiecewiseSmoothCurve(curves[i], curves[i]);
+			computePiecewiseSmoothCurve(context, curves[i], curves[i]);
 		curves[0].insert(curves[0].end(), curves[1].rbegin(), curves[1].rend());
-		polylines(designImage, curves[0], true, 0, lineThicknessOfLevel[2], LINE_AA);
+		drawCurve(context, designImage, curves[0], true, 2);
 	}
 	else {
 		vector<Point> curve;
-		computeStringCurve(teeth, positions_, distanceScales[DENTURE_BASE_CURVE], {true, true}, {true, true}, false, curve);
-		computeSmoothCurve(curve, curve);
-		polylines(designImage, curve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+		computeStringCurve(context, teeth, positions_, distanceScales[DENTURE_BASE_CURVE], {true, true}, {true, true}, false, curve);
+		computeSmoothCurve(context, curve, curve);
+		drawCurve(context, designImage, curve, false, 2);
 	}
 }
 
@@ -399,12 +404,12 @@ EdentulousSpace* EdentulousSpace::createFromIndividual(JNIEnv* const& env, jmeth
 	return new EdentulousSpace(positions);
 }
 
-void EdentulousSpace::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void EdentulousSpace::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	vector<vector<Point>> curves;
-	computeStringCurves(teeth, positions_, {0.25F, -0.25F}, {false, false}, {false, false}, false, curves);
+	computeStringCurves(context, teeth, positions_, {0.25F, -0.25F}, {false, false}, {false, false}, false, curves);
 	for (auto curve = curves.begin(); curve < curves.end(); ++curve) {
-		computeSmoothCurve(*curve, *curve);
-		polylines(designImage, *curve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+		computeSmoothCurve(context, *curve, *curve);
+		drawCurve(context, designImage, *curve, false, 2);
 	}
 }
 
@@ -418,20 +423,18 @@ FullPalatalPlate* FullPalatalPlate::createFromIndividual(JNIEnv* const& env, jme
 
 FullPalatalPlate::FullPalatalPlate(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]) : RpdAsMajorConnector(positions, hasLingualConfrontations) {}
 
-void FullPalatalPlate::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	RpdAsMajorConnector::draw(designImage, teeth);
+void FullPalatalPlate::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	RpdAsMajorConnector::draw(context, designImage, teeth);
 	vector<Point> curve, distalCurve, distalPoints;
 	vector<vector<Point>> curves;
-	computeLingualCurve(teeth, positions_, curve, curves, &distalPoints);
+	computeLingualCurve(context, teeth, positions_, curve, curves, &distalPoints);
 	reverse(curve.begin(), curve.end());
-	computeDistalCurve(teeth, positions_, distalPoints, distalCurve);
+	computeDistalCurve(context, teeth, positions_, distalPoints, distalCurve);
 	curve.insert(curve.end(), distalCurve.begin(), distalCurve.end());
-	auto const& thisDesign = Mat(designImage.size(), CV_8U, 255);
-	fillPoly(thisDesign, vector<vector<Point>>{curve}, 128, LINE_AA);
-	bitwise_and(thisDesign, designImage, designImage);
+	drawLayer(context, designImage, curve, 128);
 	for (auto thisCurve = curves.begin(); thisCurve < curves.end(); ++thisCurve)
-		polylines(designImage, *thisCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
-	polylines(designImage, distalCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+		drawCurve(context, designImage, *thisCurve, false, 2);
+	drawCurve(context, designImage, distalCurve, false, 2);
 }
 
 LingualBar* LingualBar::createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]) {
@@ -444,19 +447,17 @@ LingualBar* LingualBar::createFromIndividual(JNIEnv* const& env, jmethodID const
 
 LingualBar::LingualBar(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]) : RpdAsMajorConnector(positions, hasLingualConfrontations) {}
 
-void LingualBar::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void LingualBar::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	vector<Point> curve, tmpCurve;
 	vector<vector<Point>> curves;
 	float avgRadius;
-	computeOuterCurve(teeth, positions_, curve, &avgRadius);
-	polylines(designImage, curve, false, 0, lineThicknessOfLevel[2], LINE_AA);
-	computeInnerCurve(teeth, positions_, avgRadius, tmpCurve, curves);
+	computeOuterCurve(context, teeth, positions_, curve, &avgRadius);
+	drawCurve(context, designImage, curve, false, 2);
+	computeInnerCurve(context, teeth, positions_, avgRadius, tmpCurve, curves);
 	for (auto thisCurve = curves.begin(); thisCurve < curves.end(); ++thisCurve)
-		polylines(designImage, *thisCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+		drawCurve(context, designImage, *thisCurve, false, 2);
 	curve.insert(curve.end(), tmpCurve.rbegin(), tmpCurve.rend());
-	auto const& thisDesign = Mat(designImage.size(), CV_8U, 255);
-	fillPoly(thisDesign, vector<vector<Point>>{curve}, 128, LINE_AA);
-	bitwise_and(thisDesign, designImage, designImage);
+	drawLayer(context, designImage, curve, 128);
 }
 
 LingualPlate* LingualPlate::createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]) {
@@ -469,19 +470,17 @@ LingualPlate* LingualPlate::createFromIndividual(JNIEnv* const& env, jmethodID c
 
 LingualPlate::LingualPlate(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]) : RpdAsMajorConnector(positions, hasLingualConfrontations) {}
 
-void LingualPlate::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	RpdAsMajorConnector::draw(designImage, teeth);
+void LingualPlate::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	RpdAsMajorConnector::draw(context, designImage, teeth);
 	vector<Point> curve, tmpCurve;
-	computeOuterCurve(teeth, positions_, curve);
+	computeOuterCurve(context, teeth, positions_, curve);
 	vector<vector<Point>> curves;
-	computeLingualCurve(teeth, positions_, tmpCurve, curves);
-	polylines(designImage, curve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+	computeLingualCurve(context, teeth, positions_, tmpCurve, curves);
+	drawCurve(context, designImage, curve, false, 2);
 	for (auto thisCurve = curves.begin(); thisCurve < curves.end(); ++thisCurve)
-		polylines(designImage, *thisCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+		drawCurve(context, designImage, *thisCurve, false, 2);
 	curve.insert(curve.end(), tmpCurve.rbegin(), tmpCurve.rend());
-	auto const& thisDesign = Mat(designImage.size(), CV_8U, 255);
-	fillPoly(thisDesign, vector<vector<Point>>{curve}, 128, LINE_AA);
-	bitwise_and(thisDesign, designImage, designImage);
+	drawLayer(context, designImage, curve, 128);
 }
 
 LingualRest::LingualRest(vector<Position> const& positions, Material const& material, Direction const& direction) : Rpd(positions), RpdWithDirection(direction), RpdWithLingualRest(positions, material, direction) {}
@@ -494,19 +493,22 @@ LingualRest* LingualRest::createFromIndividual(JNIEnv* const& env, jmethodID con
 	return new LingualRest(positions, CAST, restMesialOrDistal);
 }
 
-void LingualRest::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void LingualRest::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	auto& tooth = getTooth(teeth, positions_[0]);
-	auto curve = tooth.getCurve(240, 300);
-	vector<Point> tmpCurve{curve.back(), curve[0]};
+	auto const& toothCurve = tooth.getCurve(240, 300);
+	vector<Point> tmpCurve{toothCurve.back(), toothCurve[0]};
 	auto& centroid = tooth.getCentroid();
 	for (auto i = 0; i < 2; ++i)
 		tmpCurve.insert(tmpCurve.end() - 1, centroid + (static_cast<Point2f>(tmpCurve[i * 2]) - centroid) * 0.8F);
-	computePiecewiseSmoothCurve(tmpCurve, tmpCurve);
+	computePiecewiseSmoothCurve(context, tmpCurve, tmpCurve);
+	vector<Point> curve;
+	curve.reserve(toothCurve.size() + tmpCurve.size());
+	curve.insert(curve.end(), toothCurve.begin(), toothCurve.end());
 	curve.insert(curve.end(), tmpCurve.begin(), tmpCurve.end());
-	polylines(designImage, curve, true, 0, lineThicknessOfLevel[1 + (material_ == CAST)], LINE_AA);
-	fillPoly(designImage, vector<vector<Point>>{curve}, 0, LINE_AA);
+	drawCurve(context, designImage, curve, true, 1 + (material_ == CAST));
+	drawFill(context, designImage, curve, 0);
 	auto const& isMesial = direction_ == MESIAL;
-	polylines(designImage, tooth.getCurve(isMesial ? 300 : 180, isMesial ? 0 : 240), false, 0, lineThicknessOfLevel[1 + (material_ == CAST)], LINE_AA);
+	drawCurve(context, designImage, tooth.getCurve(isMesial ? 300 : 180, isMesial ? 0 : 240), false, 1 + (material_ == CAST));
 }
 
 OcclusalRest::OcclusalRest(vector<Position> const& positions, Direction const& direction) : Rpd(positions), RpdWithDirection(direction), RpdWithClaspRootOrRest(positions, direction) {}
@@ -521,15 +523,15 @@ OcclusalRest* OcclusalRest::createFromIndividual(JNIEnv* const& env, jmethodID c
 	return new OcclusalRest(positions, restMesialOrDistal);
 }
 
-void OcclusalRest::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void OcclusalRest::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	auto& tooth = getTooth(teeth, positions_[0]);
 	auto const& isMesial = direction_ == MESIAL;
 	auto curve = tooth.getCurve(isMesial ? 340 : 160, isMesial ? 20 : 200);
 	vector<Point> tmpCurve{curve.back(), (tooth.getCentroid() + static_cast<Point2f>(tooth.getAnglePoint(isMesial ? 0 : 180))) / 2, curve[0]};
-	computeSmoothCurve(tmpCurve, tmpCurve, false, 0.3F);
+	computeSmoothCurve(context, tmpCurve, tmpCurve, false, 0.3F);
 	curve.insert(curve.end(), tmpCurve.begin(), tmpCurve.end());
-	polylines(designImage, curve, true, 0, lineThicknessOfLevel[1], LINE_AA);
-	fillPoly(designImage, vector<vector<Point>>{curve}, 0, LINE_AA);
+	drawCurve(context, designImage, curve, true, 1);
+	drawFill(context, designImage, curve, 0);
 }
 
 PalatalPlate* PalatalPlate::createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]) {
@@ -542,25 +544,23 @@ PalatalPlate* PalatalPlate::createFromIndividual(JNIEnv* const& env, jmethodID c
 
 PalatalPlate::PalatalPlate(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]) : RpdAsMajorConnector(positions, hasLingualConfrontations) {}
 
-void PalatalPlate::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	RpdAsMajorConnector::draw(designImage, teeth);
+void PalatalPlate::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	RpdAsMajorConnector::draw(context, designImage, teeth);
 	vector<Point> curve, mesialCurve, distalCurve, tmpCurve, distalPoints(2);
 	vector<vector<Point>> curves;
-	computeLingualCurve(teeth, {positions_[2], positions_[3]}, tmpCurve, curves, distalPoints[1]);
+	computeLingualCurve(context, teeth, {positions_[2], positions_[3]}, tmpCurve, curves, distalPoints[1]);
 	curve.insert(curve.end(), tmpCurve.rbegin(), tmpCurve.rend());
-	computeMesialCurve(teeth, {positions_[2], positions_[0]}, mesialCurve);
+	computeMesialCurve(context, teeth, {positions_[2], positions_[0]}, mesialCurve);
 	curve.insert(curve.end(), mesialCurve.begin(), mesialCurve.end());
-	computeLingualCurve(teeth, {positions_[0], positions_[1]}, tmpCurve, curves, distalPoints[0]);
+	computeLingualCurve(context, teeth, {positions_[0], positions_[1]}, tmpCurve, curves, distalPoints[0]);
 	curve.insert(curve.end(), tmpCurve.begin(), tmpCurve.end());
-	computeDistalCurve(teeth, {positions_[1], positions_[3]}, distalPoints, distalCurve);
+	computeDistalCurve(context, teeth, {positions_[1], positions_[3]}, distalPoints, distalCurve);
 	curve.insert(curve.end(), distalCurve.begin(), distalCurve.end());
-	auto const& thisDesign = Mat(designImage.size(), CV_8U, 255);
-	fillPoly(thisDesign, vector<vector<Point>>{curve}, 128, LINE_AA);
-	bitwise_and(thisDesign, designImage, designImage);
+	drawLayer(context, designImage, curve, 128);
 	for (auto thisCurve = curves.begin(); thisCurve < curves.end(); ++thisCurve)
-		polylines(designImage, *thisCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
-	polylines(designImage, mesialCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
-	polylines(designImage, distalCurve, false, 0, lineThicknessOfLevel[2], LINE_AA);
+		drawCurve(context, designImage, *thisCurve, false, 2);
+	drawCurve(context, designImage, mesialCurve, false, 2);
+	drawCurve(context, designImage, distalCurve, false, 2);
 }
 
 RingClasp::RingClasp(vector<Position> const& positions, Material const& material, Side const& tipSide) : Rpd(positions), RpdWithClaspRootOrRest(positions, material == CAST ? vector<Direction>{MESIAL, DISTAL} : vector<Direction>{MESIAL}), RpdWithLingualClaspArms(positions, material, MESIAL), tipSide_(tipSide) {}
@@ -575,12 +575,12 @@ RingClasp* RingClasp::createFromIndividual(JNIEnv* const& env, jmethodID const&
 	return new RingClasp(positions, claspMaterial, tipSide);
 }
 
-void RingClasp::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	OcclusalRest(positions_, MESIAL).draw(designImage, teeth);
+void RingClasp::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	OcclusalRest(positions_, MESIAL).draw(context, designImage, teeth);
 	if (material_ == CAST)
-		OcclusalRest(positions_, DISTAL).draw(designImage, teeth);
+		OcclusalRest(positions_, DISTAL).draw(context, designImage, teeth);
 	auto const& isBuccal = tipSide_ == BUCCAL;
-	polylines(designImage, getTooth(teeth, positions_[0]).getCurve(isBuccal ? 60 : 0, isBuccal ? 0 : 300), false, 0, lineThicknessOfLevel[1 + (material_ == CAST)], LINE_AA);
+	drawCurve(context, designImage, getTooth(teeth, positions_[0]).getCurve(isBuccal ? 60 : 0, isBuccal ? 0 : 300), false, 1 + (material_ == CAST));
 }
 
 void RingClasp::queryTipSide(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midResourceGetProperty, jobject const& dpClaspTipSide, jobject const& individual, Side& tipSide) {
@@ -598,10 +598,10 @@ Rpa* Rpa::createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, j
 	return new Rpa(positions, claspMaterial);
 }
 
-void Rpa::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	OcclusalRest(positions_, MESIAL).draw(designImage, teeth);
-	GuidingPlate(positions_).draw(designImage, teeth);
-	HalfClasp(positions_, material_, MESIAL, BUCCAL).draw(designImage, teeth);
+void Rpa::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	OcclusalRest(positions_, MESIAL).draw(context, designImage, teeth);
+	GuidingPlate(positions_).draw(context, designImage, teeth);
+	HalfClasp(positions_, material_, MESIAL, BUCCAL).draw(context, designImage, teeth);
 }
 
 Rpi::Rpi(vector<Position> const& positions) : Rpd(positions), RpdWithClaspRootOrRest(positions, {MESIAL, DISTAL}) {}
@@ -612,10 +612,10 @@ Rpi* Rpi::createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, j
 	return new Rpi(positions);
 }
 
-void Rpi::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
-	OcclusalRest(positions_, MESIAL).draw(designImage, teeth);
-	GuidingPlate(positions_).draw(designImage, teeth);
-	IBar(positions_).draw(designImage, teeth);
+void Rpi::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+	OcclusalRest(positions_, MESIAL).draw(context, designImage, teeth);
+	GuidingPlate(positions_).draw(context, designImage, teeth);
+	IBar(positions_).draw(context, designImage, teeth);
 }
 
 WwClasp::WwClasp(vector<Position> const& positions, Direction const& direction, bool const& enableBuccalArm, bool const& enableLingualArm, bool const& enableRest) : Rpd(positions), AkersClasp(positions, WROUGHT_WIRE, direction, enableBuccalArm, enableLingualArm, enableRest) {}
@@ -632,48 +632,34 @@ WwClasp* WwClasp::createFromIndividual(JNIEnv* const& env, jmethodID const& midG
 
 GuidingPlate::GuidingPlate(vector<Position> const& positions) : Rpd(positions) {}
 
-void GuidingPlate::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void GuidingPlate::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	auto& tooth = getTooth(teeth, positions_[0]);
 	auto& centroid = tooth.getCentroid();
 	auto const& point = centroid + (static_cast<Point2f>(tooth.getAnglePoint(180)) - centroid) * 1.1F;
-	auto const& direction = computeNormalDirection(point) * tooth.getRadius() * 2 / 3;
-	line(designImage, point, point + direction, 0, lineThicknessOfLevel[2], LINE_AA);
-	line(designImage, point, point - direction, 0, lineThicknessOfLevel[2], LINE_AA);
+	auto const& direction = computeNormalDirection(context, point) * tooth.getRadius() * 2 / 3;
+	drawLine(context, designImage, point, point + direction, 2);
+	drawLine(context, designImage, point, point - direction, 2);
 }
 
 HalfClasp::HalfClasp(vector<Position> const& positions, Material const& material, Direction const& direction, Side const& side) : Rpd(positions), RpdWithMaterial(material), RpdWithDirection(direction), side_(side) {}
 
 HalfClasp::HalfClasp(Position const& position, Material const& material, Direction const& direction, Side const& side) : HalfClasp(vector<Position>{position}, material, direction, side) {}
 
-void HalfClasp::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void HalfClasp::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	auto& tooth = getTooth(teeth, positions_[0]);
-	vector<Point> curve;
-	switch ((direction_ == DISTAL) * 2 + (side_ == LINGUAL)) {
-		case 0b00:
-			curve = tooth.getCurve(60, 180);
-			break;
-		case 0b01:
-			curve = tooth.getCurve(180, 300);
-			break;
-		case 0b10:
-			curve = tooth.getCurve(0, 120);
-			break;
-		case 0b11:
-			curve = tooth.getCurve(240, 0);
-			break;
-		default: ;
-	}
-	polylines(designImage, curve, false, 0, lineThicknessOfLevel[1 + (material_ == CAST)], LINE_AA);
+	int const angles[][2]{{60, 180}, {180, 300}, {0, 120}, {240, 0}};
+	auto const& angle = angles[(direction_ == DISTAL) * 2 + (side_ == LINGUAL)];
+	drawCurve(context, designImage, tooth.getCurve(angle[0], angle[1]), false, 1 + (material_ == CAST));
 }
 
 IBar::IBar(vector<Position> const& positions) : Rpd(positions) {}
 
-void IBar::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
+void IBar::draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const {
 	auto& tooth = getTooth(teeth, positions_[0]);
 	auto const& a = tooth.getRadius() * 1.5F;
 	auto &p1 = tooth.getAnglePoint(75), &p2 = tooth.getAnglePoint(165);
 	auto const& c = (p1 + p2) / 2;
-	auto const& d = computeNormalDirection(c);
+	auto const& d = computeNormalDirection(context, c);
 	auto const& r = p1 - c;
 	auto const& rou = norm(r);
 	auto const& sinTheta = d.cross(r) / rou;
@@ -683,5 +669,5 @@ void IBar::draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) co
 	inclination = radianToDegree(inclination);
 	if (t > 0)
 		t -= 180;
-	ellipse(designImage, c, Size(a, b), inclination, t, t + 180, 0, lineThicknessOfLevel[2], LINE_AA);
+	drawEllipse(context, designImage, c, Size2f(a, b), inclination, t, t + 180, 2);
 }
@@ -33,7 +33,8 @@ public:
 	};
 
 	virtual ~Rpd() = default;
-	virtual void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const = 0;
+	vector<Position> const& getPositions() const;
+	virtual void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const = 0;
 protected:
 	explicit Rpd(vector<Position> const& positions);
 	static void queryPositions(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, vector<Position>& positions, bool (&isEighthToothUsed)[nZones], bool const& autoComplete = false);
@@ -67,7 +68,7 @@ public:
 	void registerLingualConfrontations(vector<Tooth> (&teeth)[nZones]) const;
 protected:
 	RpdAsMajorConnector(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 	static void queryLingualConfrontations(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& individual, bool (&hasLingualConfrontations)[nZones][nTeethPerZone]);
 	bool hasLingualConfrontations_[nZones][nTeethPerZone];
 private:
@@ -103,7 +104,7 @@ public:
 protected:
 	RpdWithLingualClaspArms(vector<Position> const& positions, Material const& material, vector<Direction> const& rootDirections);
 	RpdWithLingualClaspArms(vector<Position> const& positions, Material const& material, Direction const& rootDirection);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 private:
 	void registerLingualCoverage(vector<Tooth> (&teeth)[nZones]) const override;
 	deque<bool> hasLingualArms_;
@@ -112,7 +113,7 @@ private:
 class RpdWithLingualRest : public RpdWithClaspRootOrRest, public RpdWithLingualCoverage {
 protected:
 	RpdWithLingualRest(vector<Position> const& positions, Material const& material, Direction const& direction);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class AkersClasp : public RpdWithDirection, public RpdWithClaspRootOrRest, public RpdWithLingualClaspArms {
@@ -122,7 +123,7 @@ protected:
 	AkersClasp(vector<Position> const& positions, Material const& material, Direction const& direction, bool const& enableBuccalArm, bool const& enableLingualArm, bool const& enableRest);
 	static void queryPartEnablements(JNIEnv*const& env, jmethodID const& midGetBoolean, jmethodID const& midResourceGetProperty, jobject const& dpEnableBuccalArm, jobject const& dpEnableLingualArm, jobject const& dpEnableRest, jobject const& individual, bool& enableBuccalArm, bool& enableLingualArm, bool& enableRest);
 private:
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 	void setLingualClaspArms(vector<Tooth> (&teeth)[nZones]) override;
 	bool enableBuccalArm_, enableRest_;
 };
@@ -132,7 +133,7 @@ public:
 	static CanineAkersClasp* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midResourceGetProperty, jmethodID const& midStatementGetProperty, jobject const& dpClaspTipDirection, jobject const& dpClaspMaterial, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	CanineAkersClasp(vector<Position> const& positions, Material const& claspMaterial, Direction const& direction);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 	Material claspMaterial_;
 };
 
@@ -141,7 +142,7 @@ public:
 	static CombinationAnteriorPosteriorPalatalStrap* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	CombinationAnteriorPosteriorPalatalStrap(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class CombinationClasp : public RpdWithDirection, public RpdWithClaspRootOrRest, public RpdWithLingualClaspArms {
@@ -149,7 +150,7 @@ public:
 	static CombinationClasp* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midResourceGetProperty, jmethodID const& midStatementGetProperty, jobject const& dpClaspTipDirection, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	CombinationClasp(vector<Position> const& positions, Direction const& direction);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class CombinedClasp : public RpdWithClaspRootOrRest, public RpdWithLingualClaspArms {
@@ -157,7 +158,7 @@ public:
 	static CombinedClasp* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midResourceGetProperty, jmethodID const& midStatementGetProperty, jobject const& dpClaspMaterial, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	CombinedClasp(vector<Position> const& positions, Material const& material);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class ContinuousClasp : public RpdWithClaspRootOrRest, public RpdWithLingualClaspArms {
@@ -165,7 +166,7 @@ public:
 	static ContinuousClasp* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midResourceGetProperty, jmethodID const& midStatementGetProperty, jobject const& dpClaspMaterial, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	ContinuousClasp(vector<Position> const& positions, Material const& material);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 	void setLingualClaspArms(vector<Tooth> (&teeth)[nZones]) override;
 };
 
@@ -177,12 +178,12 @@ public:
 	};
 
 	static DentureBase* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
-	void setSide(const vector<Tooth> (&teeth)[nZones]);
+	void setSide(DesignContext const& context, const vector<Tooth> (&teeth)[nZones]);
 	void registerDentureBase(vector<Tooth> (&teeth)[nZones]) const;
 	void registerExpectedAnchors(vector<Tooth> (&teeth)[nZones]) const;
 private:
 	explicit DentureBase(vector<Position> const& positions);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 	void registerDentureBase(vector<Tooth> (&teeth)[nZones], vector<Position> positions) const;
 	static void registerExpectedAnchors(vector<Tooth> (&teeth)[nZones], vector<Position> const& positions);
 	Side side_ = Side();
@@ -193,7 +194,7 @@ public:
 	static EdentulousSpace* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	explicit EdentulousSpace(vector<Position> const& positions);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class FullPalatalPlate : public RpdAsMajorConnector {
@@ -201,7 +202,7 @@ public:
 	static FullPalatalPlate* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	FullPalatalPlate(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class LingualBar : public RpdAsMajorConnector {
@@ -209,7 +210,7 @@ public:
 	static LingualBar* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	LingualBar(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class LingualPlate : public RpdAsMajorConnector {
@@ -217,7 +218,7 @@ public:
 	static LingualPlate* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	LingualPlate(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class LingualRest : public RpdWithDirection, public RpdWithLingualRest {
@@ -226,7 +227,7 @@ public:
 	static LingualRest* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midResourceGetProperty, jmethodID const& midStatementGetProperty, jobject const& dpRestMesialOrDistal, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	LingualRest(vector<Position> const& positions, Material const& material, Direction const& direction);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class OcclusalRest : public RpdWithDirection, public RpdWithClaspRootOrRest {
@@ -242,7 +243,7 @@ public:
 private:
 	OcclusalRest(vector<Position> const& positions, Direction const& direction);
 	OcclusalRest(Position const& position, Direction const& direction);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class PalatalPlate : public RpdAsMajorConnector {
@@ -250,7 +251,7 @@ public:
 	static PalatalPlate* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpLingualConfrontation, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	PalatalPlate(vector<Position> const& positions, const bool (&hasLingualConfrontations)[nZones][nTeethPerZone]);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class RingClasp : public RpdWithClaspRootOrRest, public RpdWithLingualClaspArms {
@@ -258,7 +259,7 @@ public:
 	static RingClasp* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midResourceGetProperty, jmethodID const& midStatementGetProperty, jobject const& dpClaspMaterial, jobject const& dpClaspTipSide, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	RingClasp(vector<Position> const& positions, Material const& material, Side const& tipSide);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 	static void queryTipSide(JNIEnv*const& env, jmethodID const& midGetInt, jmethodID const& midResourceGetProperty, jobject const& dpClaspTipSide, jobject const& individual, Side& tipSide);
 	Side tipSide_;
 };
@@ -268,7 +269,7 @@ public:
 	static Rpa* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midResourceGetProperty, jmethodID const& midStatementGetProperty, jobject const& dpClaspMaterial, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	Rpa(vector<Position> const& positions, Material const& material);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class Rpi : public RpdWithClaspRootOrRest {
@@ -276,7 +277,7 @@ public:
 	static Rpi* createFromIndividual(JNIEnv* const& env, jmethodID const& midGetInt, jmethodID const& midHasNext, jmethodID const& midListProperties, jmethodID const& midNext, jmethodID const& midStatementGetProperty, jobject const& dpToothZone, jobject const& dpToothOrdinal, jobject const& opComponentPosition, jobject const& individual, bool (&isEighthToothUsed)[nZones]);
 private:
 	explicit Rpi(vector<Position> const& positions);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class WwClasp : public AkersClasp {
@@ -290,7 +291,7 @@ class GuidingPlate : public Rpd {
 	friend class Rpa;
 	friend class Rpi;
 	explicit GuidingPlate(vector<Position> const& positions);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
 
 class HalfClasp : public Rpd, public RpdWithMaterial, public RpdWithDirection {
@@ -303,12 +304,12 @@ class HalfClasp : public Rpd, public RpdWithMaterial, public RpdWithDirection {
 	friend class Rpa;
 	HalfClasp(vector<Position> const& positions, Material const& material, Direction const& direction, Side const& side);
 	HalfClasp(Position const& position, Material const& material, Direction const& direction, Side const& side);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 	Side side_;
 };
 
 class IBar : public Rpd {
 	friend class Rpi;
 	explicit IBar(vector<Position> const& positions);
-	void draw(Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
+	void draw(DesignContext const& context, Mat const& designImage, const vector<Tooth> (&teeth)[nZones]) const override;
 };
@@ -18,7 +18,7 @@ RpdDesign::RpdDesign(QWidget* const& parent) : QWidget(parent) {
 	rpdViewer_ = new RpdViewer(this);
 	ui_.verticalLayout->insertWidget(0, rpdViewer_);
 	setMinimumSize(600, 600);
-	remedyImage = ui_.remedyCheckBox->isChecked();
+	context_.remedyImage = ui_.remedyCheckBox->isChecked();
 	showBaseImage_ = ui_.baseCheckBox->isChecked();
 	showDesignImage_ = ui_.designCheckBox->isChecked();
 	chsTranslator_.load(":/qrc/rpddesign_zh.qm");
@@ -68,11 +68,11 @@ void RpdDesign::changeEvent(QEvent* event) {
 }
 
 void RpdDesign::updateViewer() {
-	auto const& curImage = !remedyImage && showBaseImage_ ? baseImage_.clone() : Mat((remedyImage ? remediedDesignImages_[0].size : designImages_[0].size)(), CV_8UC3, Scalar::all(255));
+	auto const& designLayer = context_.remedyImage ? remediedDesignLayer_ : designLayer_;
+	auto const& curImage = !context_.remedyImage && showBaseImage_ ? baseImage_.clone() : Mat(designLayer.getSize(), CV_8UC3, Scalar::all(255));
 	if (showDesignImage_) {
-		auto designImages = remedyImage ? remediedDesignImages_ : designImages_;
 		Mat designImage;
-		bitwise_and(designImages[0], designImages[1], designImage);
+		designLayer.unpack(designImage);
 		cvtColor(designImage, designImage, COLOR_GRAY2BGR);
 		bitwise_and(designImage, curImage, curImage);
 	}
@@ -80,13 +80,35 @@ void RpdDesign::updateViewer() {
 }
 
 void RpdDesign::analyzeAndUpdate(Mat const& base) {
-	analyzeBaseImage(base, remediedTeeth_, remediedDesignImages_, &teeth_, &designImages_, &baseImage_);
-	updateDesign(teeth_, rpds_, designImages_, true, justLoadedRpds_);
-	updateDesign(remediedTeeth_, rpds_, remediedDesignImages_, true, justLoadedRpds_);
+	if (analysisCache_.analyzeBaseImage(context_, base, remediedTeeth_, remediedDesignImages_, &teeth_, &designImages_, &baseImage_))
+		updateDesigns();
+	else
+		QMessageBox::critical(this, tr("Error"), tr("Not a Valid Base Image!"));
+}
+
+void RpdDesign::updateDesigns() {
+	::updateDesigns(context_, teeth_, remediedTeeth_, rpds_, designImages_, remediedDesignImages_, true, justLoadedRpds_);
 	justLoadedRpds_ = false;
+	packDesigns();
 	updateViewer();
 }
 
+void RpdDesign::packDesigns() {
+	outlineLayer_ = RunLengthLayer(designImages_[0]);
+	remediedOutlineLayer_ = RunLengthLayer(remediedDesignImages_[0]);
+	designLayer_ = outlineLayer_ & RunLengthLayer(designImages_[1]);
+	remediedDesignLayer_ = remediedOutlineLayer_ & RunLengthLayer(remediedDesignImages_[1]);
+	for (auto i = 0; i < 2; ++i) {
+		designImages_[i].release();
+		remediedDesignImages_[i].release();
+	}
+}
+
+void RpdDesign::unpackOutlines() {
+	outlineLayer_.unpack(designImages_[0]);
+	remediedOutlineLayer_.unpack(remediedDesignImages_[0]);
+}
+
 void RpdDesign::loadBaseImage() {
 	auto const& fileName = QFileDialog::getOpenFileName(this, tr("Select Base Image"), "", tr("All supported formats (*.bmp *.dib *.jpeg *.jpg *.jpe *.jp2 *.png *.pbm *.pgm *.ppm *.sr *.ras *.tiff *.tif);;Windows bitmaps (*.bmp *.dib);;JPEG files (*.jpeg *.jpg *.jpe);;JPEG 2000 files (*.jp2);;Portable Network Graphics (*.png);;Portable image format (*.pbm *.pgm *.ppm);;Sun rasters (*.sr *.ras);;TIFF files (*.tiff *.tif)"));
 	if (!fileName.isEmpty()) {
@@ -101,7 +123,16 @@ void RpdDesign::loadBaseImage() {
 void RpdDesign::loadDefaultBaseImage() {
 	auto const& hRsrc = FindResource(nullptr, MAKEINTRESOURCE(IDB_PNG1), TEXT("PNG"));
 	auto const& pBuf = static_cast<uchar*>(LockResource(LoadResource(nullptr, hRsrc)));
-	analyzeAndUpdate(imdecode(vector<uchar>(pBuf, pBuf + SizeofResource(nullptr, hRsrc)), IMREAD_COLOR));
+	auto const& bufSize = SizeofResource(nullptr, hRsrc);
+	auto const& base = imdecode(vector<uchar>(pBuf, pBuf + bufSize), IMREAD_COLOR);
+	auto const& hBakedRsrc = FindResource(nullptr, MAKEINTRESOURCE(IDR_RCDATA1), RT_RCDATA);
+	auto const& pBakedBuf = static_cast<uchar*>(LockResource(LoadResource(nullptr, hBakedRsrc)));
+	if (analysisCache_.analyzeBakedImage(context_, pBakedBuf, SizeofResource(nullptr, hBakedRsrc), AnalysisCache::hashBytes(pBuf, bufSize), remediedTeeth_, remediedDesignImages_, &teeth_, &designImages_)) {
+		copyMakeBorder(base, baseImage_, baseImageBorder, baseImageBorder, baseImageBorder, baseImageBorder, BORDER_CONSTANT, Scalar::all(255));
+		updateDesigns();
+	}
+	else
+		analyzeAndUpdate(base);
 }
 
 void RpdDesign::loadRpdInfo() {
@@ -121,10 +152,11 @@ void RpdDesign::loadRpdInfo() {
 		auto const& tmpStr = env_->NewStringUTF(fileName.toUtf8().data());
 		env_->CallVoidMethod(ontModel, midRead, tmpStr);
 		env_->DeleteLocalRef(tmpStr);
-		if (queryRpds(env_, ontModel, rpds_))
+		if (queryRpds(context_, env_, ontModel, rpds_))
 			if (baseImage_.data) {
-				updateDesign(teeth_, rpds_, designImages_, false, true);
-				updateDesign(remediedTeeth_, rpds_, remediedDesignImages_, false, true);
+				unpackOutlines();
+				::updateDesigns(context_, teeth_, remediedTeeth_, rpds_, designImages_, remediedDesignImages_, false, true);
+				packDesigns();
 				updateViewer();
 			}
 			else
@@ -135,8 +167,8 @@ void RpdDesign::loadRpdInfo() {
 }
 
 void RpdDesign::onRemedyImageChanged(bool const& thisRemedyImage) {
-	remedyImage = thisRemedyImage;
-	ui_.baseCheckBox->setEnabled(!remedyImage);
+	context_.remedyImage = thisRemedyImage;
+	ui_.baseCheckBox->setEnabled(!context_.remedyImage);
 	if (baseImage_.data)
 		updateViewer();
 }
@@ -5,7 +5,7 @@
 #include <QTranslator>
 
 #include "ui_RpdDesign.h"
-#include "GlobalVariables.h"
+#include "AnalysisCache.h"
 
 class Rpd;
 class RpdViewer;
@@ -20,13 +20,19 @@ private:
 	void changeEvent(QEvent* event) override;
 	void updateViewer();
 	void analyzeAndUpdate(Mat const& base);
+	void updateDesigns();
+	void packDesigns();
+	void unpackOutlines();
 	static string jenaLibPath;
+	AnalysisCache analysisCache_;
 	bool isEnglish_ = true;
 	bool justLoadedRpds_ = false, showBaseImage_, showDesignImage_;
+	DesignContext context_;
 	JavaVM* vm_;
 	JNIEnv* env_;
 	Mat baseImage_, designImages_[2], remediedDesignImages_[2];
 	QTranslator chsTranslator_, engTranslator_;
+	RunLengthLayer designLayer_, outlineLayer_, remediedDesignLayer_, remediedOutlineLayer_;
 	RpdViewer* rpdViewer_;
 	Ui::RpdDesignClass ui_;
 	vector<Rpd*> rpds_;
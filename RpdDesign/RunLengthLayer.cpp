@@ -0,0 +1,64 @@
+#include "RunLengthLayer.h"
+
+RunLengthLayer::RunLengthLayer(Mat const& image) : size_(image.size()) {
+	for (auto row = 0; row < image.rows; ++row) {
+		auto const& pixels = image.ptr<uchar>(row);
+		for (auto col = 0; col < image.cols;) {
+			auto start = col;
+			auto const& value = pixels[col++];
+			while (col < image.cols && pixels[col] == value)
+				++col;
+			appendRun(value, col - start);
+		}
+	}
+}
+
+RunLengthLayer::RunLengthLayer(Size const& size, vector<pair<uchar, uint32_t>> const& runs) : size_(size), runs_(runs) {}
+
+RunLengthLayer RunLengthLayer::operator&(RunLengthLayer const& rhs) const {
+	CV_Assert(size_ == rhs.size_);
+	RunLengthLayer layer;
+	layer.size_ = size_;
+	layer.runs_.reserve(max(runs_.size(), rhs.runs_.size()));
+	auto lhsRun = runs_.begin(), rhsRun = rhs.runs_.begin();
+	uint32_t lhsLength = 0, rhsLength = 0;
+	while (lhsRun < runs_.end() && rhsRun < rhs.runs_.end()) {
+		if (!lhsLength)
+			lhsLength = lhsRun->second;
+		if (!rhsLength)
+			rhsLength = rhsRun->second;
+		auto const& length = min(lhsLength, rhsLength);
+		layer.appendRun(lhsRun->first & rhsRun->first, length);
+		if (!(lhsLength -= length))
+			++lhsRun;
+		if (!(rhsLength -= length))
+			++rhsRun;
+	}
+	return layer;
+}
+
+Size const& RunLengthLayer::getSize() const { return size_; }
+
+vector<pair<uchar, uint32_t>> const& RunLengthLayer::getRuns() const { return runs_; }
+
+bool RunLengthLayer::empty() const { return runs_.empty(); }
+
+void RunLengthLayer::unpack(Mat& image) const {
+	size_t nPixels = 0;
+	for (auto run = runs_.begin(); run < runs_.end(); ++run)
+		nPixels += run->second;
+	CV_Assert(nPixels == static_cast<size_t>(size_.area()));
+	image.create(size_, CV_8U);
+	auto pixels = image.data;
+	for (auto run = runs_.begin(); run < runs_.end(); ++run) {
+		memset(pixels, run->first, run->second);
+		pixels += run->second;
+	}
+}
+
+void RunLengthLayer::appendRun(uchar const& value, uint32_t const& length) {
+	if (runs_.size() && runs_.back().first == value)
+		runs_.back().second += length;
+	else
+		runs_.push_back({value, length});
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <opencv2/core/mat.hpp>
+
+#include "GlobalVariables.h"
+
+class RunLengthLayer {
+public:
+	RunLengthLayer() = default;
+	explicit RunLengthLayer(Mat const& image);
+	RunLengthLayer(Size const& size, vector<pair<uchar, uint32_t>> const& runs);
+	RunLengthLayer operator&(RunLengthLayer const& rhs) const;
+	Size const& getSize() const;
+	vector<pair<uchar, uint32_t>> const& getRuns() const;
+	bool empty() const;
+	void unpack(Mat& image) const;
+private:
+	void appendRun(uchar const& value, uint32_t const& length);
+	Size size_;
+	vector<pair<uchar, uint32_t>> runs_;
+};
@@ -0,0 +1,60 @@
+#include <opencv2/imgproc.hpp>
+
+#include "TeethTopology.h"
+#include "Tooth.h"
+#include "Utilities.h"
+
+TeethTopology::TeethTopology(DesignContext const& context, const vector<Tooth> (&teeth)[nZones]) {
+	majorConnectorCounts_[0] = 0;
+	radiusSums_[0] = 0;
+	for (auto zone = 0; zone < nZones; ++zone)
+		for (auto ordinal = 0; ordinal < nTeethPerZone; ++ordinal) {
+			auto const& position = Rpd::Position(zone, ordinal);
+			auto const& index = getIndex(position);
+			auto const& tooth = getTooth(teeth, position);
+			majorConnectorCounts_[index + 1] = majorConnectorCounts_[index] + tooth.hasMajorConnector();
+			radiusSums_[index + 1] = radiusSums_[index] + tooth.getRadius();
+			if (ordinal < nTeethPerZone - 1 || context.isEighthUsed[zone]) {
+				shouldAnchor_[index][Rpd::MESIAL] = ::shouldAnchor(context, teeth, position, Rpd::MESIAL);
+				shouldAnchor_[index][Rpd::DISTAL] = ::shouldAnchor(context, teeth, position, Rpd::DISTAL);
+			}
+		}
+}
+
+void TeethTopology::registerDentureBases(DesignContext const& context, const vector<Tooth> (&teeth)[nZones]) {
+	for (auto zone = 0; zone < nZones; ++zone) {
+		auto const& nTeeth = nTeethPerZone + context.isEighthUsed[zone] - 1;
+		for (auto ordinal = 0; ordinal < nTeethPerZone; ++ordinal) {
+			auto const& position = Rpd::Position(zone, ordinal);
+			auto const& index = getIndex(position);
+			dentureBaseCounts_[index][Rpd::MESIAL] = getTooth(teeth, position).hasDentureBase(DentureBase::DOUBLE) ? (ordinal ? dentureBaseCounts_[index - 1][Rpd::MESIAL] : 0) + 1 : 0;
+		}
+		for (auto ordinal = nTeethPerZone - 1; ordinal >= 0; --ordinal) {
+			auto const& position = Rpd::Position(zone, ordinal);
+			auto const& index = getIndex(position);
+			dentureBaseCounts_[index][Rpd::DISTAL] = ordinal < nTeeth && getTooth(teeth, position).hasDentureBase(DentureBase::DOUBLE) ? (ordinal < nTeethPerZone - 1 ? dentureBaseCounts_[index + 1][Rpd::DISTAL] : 0) + 1 : 0;
+		}
+	}
+}
+
+int TeethTopology::countDentureBases(Rpd::Position const& position, Rpd::Direction const& direction) const { return position.ordinal < nTeethPerZone ? dentureBaseCounts_[getIndex(position)][direction] : 0; }
+
+bool TeethTopology::isBlockedByMajorConnector(vector<Rpd::Position> const& positions) const {
+	if (positions[0].zone == positions[1].zone)
+		return countMajorConnectors(positions[0], positions[1]) > 0;
+	return countMajorConnectors(Rpd::Position(positions[0].zone, 0), positions[0]) > 0 || countMajorConnectors(Rpd::Position(positions[1].zone, 0), positions[1]) > 0;
+}
+
+bool TeethTopology::shouldAnchor(Rpd::Position const& position, Rpd::Direction const& direction) const { return shouldAnchor_[getIndex(position)][direction]; }
+
+float TeethTopology::getSumOfRadii(Rpd::Position const& startPosition, Rpd::Position const& endPosition) const {
+	CV_Assert(!(endPosition < startPosition));
+	return radiusSums_[getIndex(endPosition) + 1] - radiusSums_[getIndex(startPosition)];
+}
+
+int TeethTopology::getIndex(Rpd::Position const& position) { return position.zone * nTeethPerZone + position.ordinal; }
+
+int TeethTopology::countMajorConnectors(Rpd::Position const& startPosition, Rpd::Position const& endPosition) const {
+	CV_Assert(!(endPosition < startPosition));
+	return majorConnectorCounts_[getIndex(endPosition) + 1] - majorConnectorCounts_[getIndex(startPosition)];
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Rpd.h"
+
+class TeethTopology {
+public:
+	TeethTopology(DesignContext const& context, const vector<Tooth> (&teeth)[nZones]);
+	void registerDentureBases(DesignContext const& context, const vector<Tooth> (&teeth)[nZones]);
+	int countDentureBases(Rpd::Position const& position, Rpd::Direction const& direction) const;
+	bool isBlockedByMajorConnector(vector<Rpd::Position> const& positions) const;
+	bool shouldAnchor(Rpd::Position const& position, Rpd::Direction const& direction) const;
+	float getSumOfRadii(Rpd::Position const& startPosition, Rpd::Position const& endPosition) const;
+private:
+	static int getIndex(Rpd::Position const& position);
+	int countMajorConnectors(Rpd::Position const& startPosition, Rpd::Position const& endPosition) const;
+	bool shouldAnchor_[nZones * nTeethPerZone][2] = {};
+	int dentureBaseCounts_[nZones * nTeethPerZone][2] = {};
+	int majorConnectorCounts_[nZones * nTeethPerZone + 1];
+	double radiusSums_[nZones * nTeethPerZone + 1];
+};
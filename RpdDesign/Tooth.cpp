@@ -3,44 +3,76 @@
 #include "Tooth.h"
 #include "Utilities.h"
 
-bool Tooth::isEighthUsed[nZones];
-
 Tooth::Tooth(vector<Point> const& contour) { setContour(contour); }
 
-vector<Point> const& Tooth::getContour() const { return contour_; }
+vector<Point> const& Tooth::getContour() const {
+	updateContour();
+	return contour_;
+}
 
 void Tooth::setContour(vector<Point> const& contour) {
 	contour_ = contour;
+	baseContour_.reset();
+	curves_.clear();
+	sweepSign_ = 0;
+	isTransformOutdated_ = false;
 	auto const& moment = moments(contour);
 	radius_ = sqrt(moment.m00 / CV_PI);
 	centroid_ = Point2f(moment.m10 / moment.m00, moment.m01 / moment.m00);
 }
 
-Point const& Tooth::getAnglePoint(int const& angle) const { return contour_[anglePointIndices_[angle]]; }
+Point const& Tooth::getAnglePoint(int const& angle) const {
+	if (!sweepSign_)
+		return getContour()[0];
+	resolveAnglePoint(angle);
+	return anglePoints_[angle];
+}
 
-vector<Point> Tooth::getCurve(int const& startAngle, int const& endAngle, bool const& isConvex) const {
+vector<Point> const& Tooth::getCurve(int const& startAngle, int const& endAngle, bool const& isConvex) const {
+	auto const& key = make_tuple(startAngle, endAngle, isConvex);
+	auto const& curve = curves_.find(key);
+	if (curve != curves_.end()) {
+		++nCurveHits_;
+		return curve->second;
+	}
+	++nCurveMisses_;
+	auto thisCurve = computeCurve(startAngle, endAngle, isConvex);
+	return curves_[key] = move(thisCurve);
+}
+
+vector<Point> Tooth::computeCurve(int const& startAngle, int const& endAngle, bool const& isConvex) const {
 	auto midAngle = (startAngle + endAngle) / 2;
 	if (startAngle > endAngle)
 		midAngle = (midAngle + 180) % 360;
-	auto const& startIdx = anglePointIndices_[startAngle];
-	auto const& midIdx = anglePointIndices_[midAngle];
-	auto const& endIdx = anglePointIndices_[endAngle];
-	vector<Point> curve;
-	if ((midIdx - startIdx) * (endIdx - midIdx) >= 0)
-		if (startIdx < endIdx)
-			curve = vector<Point>(contour_.begin() + startIdx, contour_.begin() + endIdx + 1);
-		else
-			curve = vector<Point>(contour_.rend() - startIdx - 1, contour_.rend() - endIdx);
-	else if (startIdx < endIdx) {
-		curve = vector<Point>(contour_.rend() - startIdx - 1, contour_.rend());
-		curve.insert(curve.end(), contour_.rbegin(), contour_.rend() - endIdx);
-	}
-	else {
-		curve = vector<Point>(contour_.begin() + startIdx, contour_.end());
-		curve.insert(curve.end(), contour_.begin(), contour_.begin() + endIdx + 1);
-	}
+	if (!sweepSign_)
+		return vector<Point>{getContour()[0]};
+	resolveAnglePoint(startAngle);
+	resolveAnglePoint(midAngle);
+	resolveAnglePoint(endAngle);
+	auto const& startPosition = getAnglePointPosition(startAngle);
+	auto const& midPosition = getAnglePointPosition(midAngle);
+	auto const& endPosition = getAnglePointPosition(endAngle);
+	auto const& nPoints = static_cast<int>(contour_.size());
+	auto const& isWrapped = (midPosition - startPosition) * (endPosition - midPosition) < 0;
+	auto const& isForward = isWrapped != startPosition < endPosition;
+	auto const& firstAngle = isForward ? startAngle : endAngle;
+	auto const& lastAngle = isForward ? endAngle : startAngle;
+	auto const& lastSegment = anglePointSegments_[lastAngle];
+	thread_local vector<Point> curve;
+	curve.assign(1, anglePoints_[firstAngle]);
+	auto idx = anglePointSegments_[firstAngle];
+	if (idx != lastSegment || anglePointParams_[firstAngle] > anglePointParams_[lastAngle])
+		do {
+			idx = (idx + 1) % nPoints;
+			if (contour_[idx] != curve.back())
+				curve.push_back(contour_[idx]);
+		} while (idx != lastSegment);
+	if (anglePoints_[lastAngle] != curve.back())
+		curve.push_back(anglePoints_[lastAngle]);
+	if (!isForward)
+		reverse(curve.begin(), curve.end());
 	if (isConvex) {
-		vector<int> convexIdx;
+		thread_local vector<int> convexIdx;
 		convexHull(curve, convexIdx);
 		auto const& minMaxIts = minmax_element(convexIdx.begin(), convexIdx.end());
 		vector<Point> convexCurve;
@@ -74,86 +106,128 @@ Point2f const& Tooth::getNormalDirection() const { return normalDirection_; }
 
 void Tooth::setNormalDirection(Point2f const& normalDirection) { normalDirection_ = normalDirection; }
 
+void Tooth::rotateContour(Point2f const& center, float const& angle) {
+	prepareTransform();
+	angle_ += angle;
+	offset_ = center + rotate(offset_ - center, angle);
+	centroid_ = center + rotate(centroid_ - center, angle);
+}
+
+void Tooth::translateContour(Point const& translation) {
+	prepareTransform();
+	offset_ += static_cast<Point2f>(translation);
+	centroid_ += static_cast<Point2f>(translation);
+}
+
+void Tooth::prepareTransform() {
+	if (!baseContour_) {
+		updateContour();
+		baseContour_ = make_shared<vector<Point> const>(move(contour_));
+		contour_.clear();
+		angle_ = 0;
+		offset_ = Point2f();
+	}
+	curves_.clear();
+	sweepSign_ = 0;
+	isTransformOutdated_ = true;
+}
+
 void Tooth::findAnglePoints(int const& zone) {
-	auto const& signVal = 1 - zone % 2 * 2;
+	updateContour();
+	sweepSign_ = 1 - zone % 2 * 2;
+	nAnglePoints_ = 0;
+	anglePointSegments_.resize(360);
+	anglePointParams_.resize(360);
+	anglePoints_.resize(360);
+	curves_.clear();
+}
+
+float Tooth::getAnglePointPosition(int const& angle) const { return anglePointSegments_[angle] + anglePointParams_[angle]; }
+
+void Tooth::resolveAnglePoint(int const& angle) const {
+	auto const& order = sweepSign_ == 1 ? angle : 359 - angle;
+	if (!sweepSign_ || order < nAnglePoints_)
+		return;
+	updateContour();
+	auto const& nPoints = static_cast<int>(contour_.size());
 	auto const& deltaAngle = degreeToRadian(1);
-	int angle;
-	float targetAngle;
-	if (signVal == 1) {
-		angle = 0;
-		targetAngle = CV_PI / 2;
-	}
-	else {
-		angle = 359;
-		targetAngle = CV_PI / 2 * 3 - deltaAngle;
-	}
-	auto nPoints = contour_.size();
-	auto j = 0;
-	while (angle >= 0 && angle < 360) {
-		auto isFound = false;
-		auto const& d = rotate(normalDirection_, targetAngle);
-		while (!isFound) {
+	auto j = nAnglePoints_ ? anglePointSegments_[sweepSign_ == 1 ? nAnglePoints_ - 1 : 360 - nAnglePoints_] : 0;
+	for (; nAnglePoints_ <= order; ++nAnglePoints_) {
+		auto const& thisAngle = sweepSign_ == 1 ? nAnglePoints_ : 359 - nAnglePoints_;
+		auto const& d = rotate(normalDirection_, sweepSign_ == 1 ? CV_PI / 2 - thisAngle * deltaAngle : CV_PI / 2 * 3 - (360 - thisAngle) * deltaAngle);
+		anglePointSegments_[thisAngle] = j;
+		anglePointParams_[thisAngle] = 0;
+		anglePoints_[thisAngle] = contour_[j];
+		for (auto i = 0; i < nPoints; ++i, j = (j + 1) % nPoints) {
 			auto const& p1 = contour_[j];
 			auto const& p2 = contour_[(j + 1) % nPoints];
 			auto const& t = d.cross(centroid_ - static_cast<Point2f>(p1)) / d.cross(p2 - p1);
 			if (t >= 0 && t < 1) {
 				auto const& point = p1 + t * (p2 - p1);
 				if (d.dot(static_cast<Point2f>(point) - centroid_) > 0) {
-					if (point == p1)
-						anglePointIndices_[angle] = j;
-					else if (point == p2)
-						anglePointIndices_[angle] = (j + 1) % nPoints;
-					else {
-						contour_.insert(contour_.begin() + ++j, point);
-						++nPoints;
-						for (auto k = 0; k < 360; ++k)
-							if (anglePointIndices_[k] >= j)
-								++anglePointIndices_[k];
-						anglePointIndices_[angle] = j--;
-					}
-					isFound = true;
+					anglePointSegments_[thisAngle] = j;
+					anglePointParams_[thisAngle] = t;
+					anglePoints_[thisAngle] = point;
+					break;
 				}
 			}
-			if (!isFound)
-				j = (j + 1) % nPoints;
 		}
-		angle += signVal;
-		targetAngle -= deltaAngle;
 	}
 }
 
-bool const& Tooth::expectDentureBaseAnchor(Rpd::Direction const& direction) const { return direction == Rpd::MESIAL ? expectMesialDentureBaseAnchor_ : expectDistalDentureBaseAnchor_; }
+void Tooth::updateContour() const {
+	if (!isTransformOutdated_)
+		return;
+	auto const& baseContour = *baseContour_;
+	contour_.resize(baseContour.size());
+	for (auto i = 0; i < baseContour.size(); ++i)
+		contour_[i] = rotate(baseContour[i], angle_) + offset_;
+	isTransformOutdated_ = false;
+}
 
-bool const& Tooth::expectMajorConnectorAnchor(Rpd::Direction const& direction) const { return direction == Rpd::MESIAL ? expectMesialMajorConnectorAnchor_ : expectDistalMajorConnectorAnchor_; }
+bool Tooth::expectDentureBaseAnchor(Rpd::Direction const& direction) const { return flags_ & (direction == Rpd::MESIAL ? EXPECT_MESIAL_DENTURE_BASE_ANCHOR : EXPECT_DISTAL_DENTURE_BASE_ANCHOR); }
 
-bool const& Tooth::hasClaspRootOrRest(Rpd::Direction const& direction) const { return direction == Rpd::MESIAL ? hasMesialClaspRootOrRest_ : hasDistalClaspRootOrRest_; }
+bool Tooth::expectMajorConnectorAnchor(Rpd::Direction const& direction) const { return flags_ & (direction == Rpd::MESIAL ? EXPECT_MESIAL_MAJOR_CONNECTOR_ANCHOR : EXPECT_DISTAL_MAJOR_CONNECTOR_ANCHOR); }
 
-bool const& Tooth::hasDentureBase(DentureBase::Side const& side) const { return side == DentureBase::SINGLE ? hasSingleSidedDentureBase_ : hasDoubleSidedDentureBase_; }
+bool Tooth::hasClaspRootOrRest(Rpd::Direction const& direction) const { return flags_ & (direction == Rpd::MESIAL ? HAS_MESIAL_CLASP_ROOT_OR_REST : HAS_DISTAL_CLASP_ROOT_OR_REST); }
 
-bool const& Tooth::hasLingualConfrontation() const { return hasLingualConfrontation_; }
+bool Tooth::hasDentureBase(DentureBase::Side const& side) const { return flags_ & (side == DentureBase::SINGLE ? HAS_SINGLE_SIDED_DENTURE_BASE : HAS_DOUBLE_SIDED_DENTURE_BASE); }
 
-bool const& Tooth::hasLingualCoverage(Rpd::Direction const& direction) const { return direction == Rpd::MESIAL ? hasMesialLingualCoverage_ : hasDistalLingualCoverage_; }
+bool Tooth::hasLingualConfrontation() const { return flags_ & HAS_LINGUAL_CONFRONTATION; }
 
-bool const& Tooth::hasLingualRest(Rpd::Direction const& direction) const { return direction == Rpd::MESIAL ? hasMesialLingualRest_ : hasDistalLingualRest_; }
+bool Tooth::hasLingualCoverage(Rpd::Direction const& direction) const { return flags_ & (direction == Rpd::MESIAL ? HAS_MESIAL_LINGUAL_COVERAGE : HAS_DISTAL_LINGUAL_COVERAGE); }
 
-bool const& Tooth::hasMajorConnector() const { return hasMajorConnector_; }
+bool Tooth::hasLingualRest(Rpd::Direction const& direction) const { return flags_ & (direction == Rpd::MESIAL ? HAS_MESIAL_LINGUAL_REST : HAS_DISTAL_LINGUAL_REST); }
+
+bool Tooth::hasMajorConnector() const { return flags_ & HAS_MAJOR_CONNECTOR; }
 
 float const& Tooth::getRadius() const { return radius_; }
 
-void Tooth::setClaspRootOrRest(Rpd::Direction const& direction) { (direction == Rpd::MESIAL ? hasMesialClaspRootOrRest_ : hasDistalClaspRootOrRest_) = true; }
+void Tooth::setClaspRootOrRest(Rpd::Direction const& direction) { flags_ |= direction == Rpd::MESIAL ? HAS_MESIAL_CLASP_ROOT_OR_REST : HAS_DISTAL_CLASP_ROOT_OR_REST; }
+
+void Tooth::setDentureBase(DentureBase::Side const& side) { flags_ |= side == DentureBase::SINGLE ? HAS_SINGLE_SIDED_DENTURE_BASE : HAS_DOUBLE_SIDED_DENTURE_BASE; }
+
+void Tooth::setExpectedDentureBaseAnchor(Rpd::Direction const& direction) { flags_ |= direction == Rpd::MESIAL ? EXPECT_MESIAL_DENTURE_BASE_ANCHOR : EXPECT_DISTAL_DENTURE_BASE_ANCHOR; }
 
-void Tooth::setDentureBase(DentureBase::Side const& side) { (side == DentureBase::SINGLE ? hasSingleSidedDentureBase_ : hasDoubleSidedDentureBase_) = true; }
+void Tooth::setExpectedMajorConnectorAnchor(Rpd::Direction const& direction) { flags_ |= direction == Rpd::MESIAL ? EXPECT_MESIAL_MAJOR_CONNECTOR_ANCHOR : EXPECT_DISTAL_MAJOR_CONNECTOR_ANCHOR; }
 
-void Tooth::setExpectedDentureBaseAnchor(Rpd::Direction const& direction) { (direction == Rpd::MESIAL ? expectMesialDentureBaseAnchor_ : expectDistalDentureBaseAnchor_) = true; }
+void Tooth::setLingualConfrontation() { flags_ |= HAS_LINGUAL_CONFRONTATION; }
 
-void Tooth::setExpectedMajorConnectorAnchor(Rpd::Direction const& direction) { (direction == Rpd::MESIAL ? expectMesialMajorConnectorAnchor_ : expectDistalMajorConnectorAnchor_) = true; }
+void Tooth::setLingualCoverage(Rpd::Direction const& direction) { flags_ |= direction == Rpd::MESIAL ? HAS_MESIAL_LINGUAL_COVERAGE : HAS_DISTAL_LINGUAL_COVERAGE; }
 
-void Tooth::setLingualConfrontation() { hasLingualConfrontation_ = true; }
+void Tooth::setLingualRest(Rpd::Direction const& direction) { flags_ |= direction == Rpd::MESIAL ? HAS_MESIAL_LINGUAL_REST : HAS_DISTAL_LINGUAL_REST; }
 
-void Tooth::setLingualCoverage(Rpd::Direction const& direction) { (direction == Rpd::MESIAL ? hasMesialLingualCoverage_ : hasDistalLingualCoverage_) = true; }
+void Tooth::setMajorConnector() { flags_ |= HAS_MAJOR_CONNECTOR; }
 
-void Tooth::setLingualRest(Rpd::Direction const& direction) { (direction == Rpd::MESIAL ? hasMesialLingualRest_ : hasDistalLingualRest_) = true; }
+void Tooth::unsetAll() { flags_ = 0; }
 
-void Tooth::setMajorConnector() { hasMajorConnector_ = true; }
+size_t Tooth::getCurveCacheHits() const { return nCurveHits_; }
+
+size_t Tooth::getCurveCacheMisses() const { return nCurveMisses_; }
+
+void Tooth::addCurveCacheCounts(Tooth const& tooth) {
+	nCurveHits_ += tooth.nCurveHits_;
+	nCurveMisses_ += tooth.nCurveMisses_;
+}
 
-void Tooth::unsetAll() { expectDistalDentureBaseAnchor_ = expectDistalMajorConnectorAnchor_ = expectMesialDentureBaseAnchor_ = expectMesialMajorConnectorAnchor_ = hasDistalClaspRootOrRest_ = hasDistalLingualCoverage_ = hasDistalLingualRest_ = hasDoubleSidedDentureBase_ = hasLingualConfrontation_ = hasMajorConnector_ = hasMesialClaspRootOrRest_ = hasMesialLingualCoverage_ = hasMesialLingualRest_ = hasSingleSidedDentureBase_ = false; }
+void Tooth::resetCurveCacheCounts() { nCurveHits_ = nCurveMisses_ = 0; }
@@ -1,24 +1,33 @@
 #pragma once
 
+#include <map>
+#include <memory>
+#include <tuple>
+
 #include "Rpd.h"
 
 class Tooth {
+	friend class AnalysisCache;
 public:
 	explicit Tooth(vector<Point> const& contour);
-	bool const& expectDentureBaseAnchor(Rpd::Direction const& direction) const;
-	bool const& expectMajorConnectorAnchor(Rpd::Direction const& direction) const;
-	bool const& hasClaspRootOrRest(Rpd::Direction const& direction) const;
-	bool const& hasDentureBase(DentureBase::Side const& side) const;
-	bool const& hasLingualConfrontation() const;
-	bool const& hasLingualCoverage(Rpd::Direction const& direction) const;
-	bool const& hasLingualRest(Rpd::Direction const& direction) const;
-	bool const& hasMajorConnector() const;
+	bool expectDentureBaseAnchor(Rpd::Direction const& direction) const;
+	bool expectMajorConnectorAnchor(Rpd::Direction const& direction) const;
+	bool hasClaspRootOrRest(Rpd::Direction const& direction) const;
+	bool hasDentureBase(DentureBase::Side const& side) const;
+	bool hasLingualConfrontation() const;
+	bool hasLingualCoverage(Rpd::Direction const& direction) const;
+	bool hasLingualRest(Rpd::Direction const& direction) const;
+	bool hasMajorConnector() const;
 	float const& getRadius() const;
 	Point const& getAnglePoint(int const& angle) const;
 	Point2f const& getCentroid() const;
 	Point2f const& getNormalDirection() const;
+	size_t getCurveCacheHits() const;
+	size_t getCurveCacheMisses() const;
 	vector<Point> const& getContour() const;
-	vector<Point> getCurve(int const& startAngle, int const& endAngle, bool const& isConvex = true) const;
+	// Memoized; the reference stays valid until the contour is set or transformed or findAnglePoints is called again
+	vector<Point> const& getCurve(int const& startAngle, int const& endAngle, bool const& isConvex = true) const;
+	void addCurveCacheCounts(Tooth const& tooth);
 	void findAnglePoints(int const& zone);
 	void setClaspRootOrRest(Rpd::Direction const& direction);
 	void setContour(vector<Point> const& contour);
@@ -30,12 +39,43 @@ public:
 	void setLingualRest(Rpd::Direction const& direction);
 	void setMajorConnector();
 	void setNormalDirection(Point2f const& normalDirection);
+	void resetCurveCacheCounts();
+	void rotateContour(Point2f const& center, float const& angle);
+	void translateContour(Point const& translation);
 	void unsetAll();
-	static bool isEighthUsed[nZones];
 private:
-	bool expectDistalDentureBaseAnchor_ = false, expectDistalMajorConnectorAnchor_ = false, expectMesialDentureBaseAnchor_ = false, expectMesialMajorConnectorAnchor_ = false, hasDistalClaspRootOrRest_ = false, hasDistalLingualCoverage_ = false, hasDistalLingualRest_ = false, hasDoubleSidedDentureBase_ = false, hasLingualConfrontation_ = false, hasMajorConnector_ = false, hasMesialClaspRootOrRest_ = false, hasMesialLingualCoverage_ = false, hasMesialLingualRest_ = false, hasSingleSidedDentureBase_ = false;
-	float radius_;
-	Point2f centroid_, normalDirection_;
-	vector<int> anglePointIndices_ = vector<int>(360);
-	vector<Point> contour_;
+	float getAnglePointPosition(int const& angle) const;
+	vector<Point> computeCurve(int const& startAngle, int const& endAngle, bool const& isConvex) const;
+	void prepareTransform();
+	void resolveAnglePoint(int const& angle) const;
+	void updateContour() const;
+	enum Flag : uint16_t {
+		EXPECT_DISTAL_DENTURE_BASE_ANCHOR = 1 << 0,
+		EXPECT_DISTAL_MAJOR_CONNECTOR_ANCHOR = 1 << 1,
+		EXPECT_MESIAL_DENTURE_BASE_ANCHOR = 1 << 2,
+		EXPECT_MESIAL_MAJOR_CONNECTOR_ANCHOR = 1 << 3,
+		HAS_DISTAL_CLASP_ROOT_OR_REST = 1 << 4,
+		HAS_DISTAL_LINGUAL_COVERAGE = 1 << 5,
+		HAS_DISTAL_LINGUAL_REST = 1 << 6,
+		HAS_DOUBLE_SIDED_DENTURE_BASE = 1 << 7,
+		HAS_LINGUAL_CONFRONTATION = 1 << 8,
+		HAS_MAJOR_CONNECTOR = 1 << 9,
+		HAS_MESIAL_CLASP_ROOT_OR_REST = 1 << 10,
+		HAS_MESIAL_LINGUAL_COVERAGE = 1 << 11,
+		HAS_MESIAL_LINGUAL_REST = 1 << 12,
+		HAS_SINGLE_SIDED_DENTURE_BASE = 1 << 13
+	};
+
+	mutable bool isTransformOutdated_ = false;
+	uint16_t flags_ = 0;
+	int sweepSign_ = 0;
+	mutable int nAnglePoints_ = 0;
+	mutable size_t nCurveHits_ = 0, nCurveMisses_ = 0;
+	float radius_, angle_ = 0;
+	Point2f centroid_, normalDirection_, offset_;
+	shared_ptr<vector<Point> const> baseContour_;
+	mutable vector<int> anglePointSegments_;
+	mutable vector<float> anglePointParams_;
+	mutable vector<Point> anglePoints_, contour_;
+	mutable map<tuple<int, int, bool>, vector<Point>> curves_;
 };
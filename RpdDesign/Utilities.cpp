@@ -1,9 +1,19 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
 #include "Utilities.h"
+#include "CurveCache.h"
+#include "DisplayList.h"
 #include "EllipticCurve.h"
+#include "ImageEncoder.h"
+#include "TeethTopology.h"
 #include "Tooth.h"
 
 float degreeToRadian(float const& degree) { return degree / 180 * CV_PI; }
@@ -29,57 +39,63 @@ Tooth const& getTooth(const vector<Tooth> (&teeth)[nZones], Rpd::Position const&
 
 Tooth& getTooth(vector<Tooth> (&teeth)[nZones], Rpd::Position const& position) { return const_cast<Tooth&>(getTooth(const_cast<const vector<Tooth>(&)[nZones]>(teeth), position)); }
 
-bool isBlockedByMajorConnector(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions) {
-	if (positions[0].zone == positions[1].zone) {
-		for (auto position = positions[0]; position <= positions[1]; ++position)
-			if (getTooth(teeth, position).hasMajorConnector())
-				return true;
-		return false;
-	}
-	return isBlockedByMajorConnector(teeth, {Rpd::Position(positions[0].zone, 0), positions[0]}) || isBlockedByMajorConnector(teeth, {Rpd::Position(positions[1].zone, 0), positions[1]});
-}
-
-void computeStringCurves(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<float> const& distanceScales, deque<bool> const& keepStartEndPoints, deque<bool> const& considerAnchorDisplacements, bool const& considerDistalPoints, vector<vector<Point>>& curves, float* const& sumOfRadii, int* const& nTeeth, vector<Point>* const& distalPoints) {
+void computeStringCurves(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<float> const& distanceScales, deque<bool> const& keepStartEndPoints, deque<bool> const& considerAnchorDisplacements, bool const& considerDistalPoints, vector<vector<Point>>& curves, float* const& sumOfRadii, int* const& nTeeth, vector<Point>* const& distalPoints) {
 	auto thisNTeeth = 0;
 	if (nTeeth)
 		thisNTeeth = *nTeeth;
 	float thisSumOfRadii = 0;
 	if (sumOfRadii)
 		thisSumOfRadii = *sumOfRadii;
-	vector<Point> curve;
+	auto values = distanceScales;
+	values.insert(values.end(), {static_cast<float>(keepStartEndPoints[0]), static_cast<float>(keepStartEndPoints[1]), static_cast<float>(considerAnchorDisplacements[0]), static_cast<float>(considerAnchorDisplacements[1]), static_cast<float>(considerDistalPoints), thisSumOfRadii, static_cast<float>(thisNTeeth)});
+	auto const& key = CurveCache::getKey(CurveCache::STRING_CURVES, positions, values);
+	auto const& entry = context.curveCache->find(key);
+	if (entry) {
+		curves = entry->curves;
+		if (nTeeth)
+			*nTeeth = entry->count;
+		if (sumOfRadii)
+			*sumOfRadii = entry->value;
+		if (distalPoints)
+			for (auto i = 0; i < 2; ++i)
+				if (entry->points[i] != Point())
+					(*distalPoints)[i] = entry->points[i];
+		return;
+	}
+	vector<Point> curve, thisDistalPoints(2);
 	if (positions[0].zone == positions[1].zone) {
 		Point lastPoint;
 		for (auto position = positions[0]; position <= positions[1]; ++position) {
 			++thisNTeeth;
 			auto& tooth = getTooth(teeth, position);
-			thisSumOfRadii += tooth.getRadius();
 			auto& thisPoint = tooth.getAnglePoint(0);
 			curve.push_back(position == positions[0] ? thisPoint : (thisPoint + lastPoint) / 2);
 			curve.push_back(tooth.getCentroid());
 			lastPoint = tooth.getAnglePoint(180);
 		}
 		curve.push_back(lastPoint);
+		thisSumOfRadii += context.topology->getSumOfRadii(positions[0], positions[1]);
 		if (considerAnchorDisplacements[0]) {
 			auto const& position = --Rpd::Position(positions[0]);
 			auto& tooth = getTooth(teeth, position);
 			if (positions[0].ordinal) {
-				if (tooth.expectMajorConnectorAnchor(Rpd::MESIAL) && !shouldAnchor(teeth, position, Rpd::MESIAL))
+				if (tooth.expectMajorConnectorAnchor(Rpd::MESIAL) && !context.topology->shouldAnchor(position, Rpd::MESIAL))
 					curve[0] = tooth.getAnglePoint(180);
 			}
-			else if (tooth.expectMajorConnectorAnchor(Rpd::DISTAL) && !shouldAnchor(teeth, position, Rpd::DISTAL))
+			else if (tooth.expectMajorConnectorAnchor(Rpd::DISTAL) && !context.topology->shouldAnchor(position, Rpd::DISTAL))
 				curve[0] = tooth.getAnglePoint(0);
 		}
-		if (considerAnchorDisplacements[1] && !isLastTooth(positions[1])) {
+		if (considerAnchorDisplacements[1] && !isLastTooth(context, positions[1])) {
 			auto const& position = ++Rpd::Position(positions[1]);
 			auto& tooth = getTooth(teeth, position);
-			if (tooth.expectMajorConnectorAnchor(Rpd::DISTAL) && !shouldAnchor(teeth, position, Rpd::DISTAL))
+			if (tooth.expectMajorConnectorAnchor(Rpd::DISTAL) && !context.topology->shouldAnchor(position, Rpd::DISTAL))
 				curve.back() = tooth.getAnglePoint(0);
 		}
 	}
 	else {
 		vector<vector<Point>> tmpCurves(2);
 		for (auto i = 0; i < 2; ++i)
-			computeStringCurve(teeth, {Rpd::Position(positions[i].zone, 0), positions[i]}, 0, {false, false}, {false, considerAnchorDisplacements[i]}, false, tmpCurves[i], &thisSumOfRadii, &thisNTeeth);
+			computeStringCurve(context, teeth, {Rpd::Position(positions[i].zone, 0), positions[i]}, 0, {false, false}, {false, considerAnchorDisplacements[i]}, false, tmpCurves[i], &thisSumOfRadii, &thisNTeeth);
 		tmpCurves[0][0] = (tmpCurves[0][0] + tmpCurves[1][0]) / 2;
 		tmpCurves[1].erase(tmpCurves[1].begin());
 		tmpCurves[1].insert(tmpCurves[1].begin(), tmpCurves[0].rbegin(), tmpCurves[0].rend());
@@ -91,49 +107,56 @@ void computeStringCurves(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Posit
 		*sumOfRadii = thisSumOfRadii;
 	auto thisAvgRadius = thisSumOfRadii / thisNTeeth;
 	if (considerDistalPoints) {
-		if (positions[0].zone != positions[1].zone && isLastTooth(positions[0])) {
+		if (positions[0].zone != positions[1].zone && isLastTooth(context, positions[0])) {
 			auto& tmpPoint = getTooth(teeth, positions[0]).getAnglePoint(180);
-			curve.insert(curve.begin(), tmpPoint + roundToPoint(rotate(computeNormalDirection(tmpPoint), -CV_PI / 2) * thisAvgRadius * 0.6F));
-			if (distalPoints)
-				(*distalPoints)[0] = curve[0];
+			curve.insert(curve.begin(), tmpPoint + roundToPoint(rotate(computeNormalDirection(context, tmpPoint), -CV_PI / 2) * thisAvgRadius * 0.6F));
+			thisDistalPoints[0] = curve[0];
 		}
-		if (isLastTooth(positions[1])) {
+		if (isLastTooth(context, positions[1])) {
 			auto& tmpPoint = getTooth(teeth, positions[1]).getAnglePoint(180);
-			curve.push_back(tmpPoint + roundToPoint(rotate(computeNormalDirection(tmpPoint), CV_PI * (positions[1].zone % 2 - 0.5)) * thisAvgRadius * 0.6F));
-			if (distalPoints)
-				(*distalPoints)[1] = curve.back();
+			curve.push_back(tmpPoint + roundToPoint(rotate(computeNormalDirection(context, tmpPoint), CV_PI * (positions[1].zone % 2 - 0.5)) * thisAvgRadius * 0.6F));
+			thisDistalPoints[1] = curve.back();
 		}
 	}
-	curves.clear();
-	for (auto i = 0; i < distanceScales.size(); ++i)
-		curves.push_back(curve);
-	for (auto i = 0; i < curve.size(); ++i) {
-		auto delta = computeNormalDirection(curve[i]) * thisAvgRadius;
-		for (auto j = 0; j < distanceScales.size(); ++j)
-			curves[j][i] += roundToPoint(delta * distanceScales[j]);
-		if (i == 0 && keepStartEndPoints[0]) {
-			for (auto j = 0; j < distanceScales.size(); ++j)
-				curves[j].insert(curves[j].begin(), curve[0]);
-			curve.insert(curve.begin(), curve[0]);
-			++i;
-		}
-		else if (i == curve.size() - 1 && keepStartEndPoints[1]) {
-			for (auto j = 0; j < distanceScales.size(); ++j)
-				curves[j].push_back(curve.back());
-			curve.push_back(curve.back());
-			++i;
-		}
+	vector<Point2f> normalDirections;
+	computeNormalDirections(context, curve, normalDirections);
+	curves.assign(distanceScales.size(), curve);
+	for (auto j = 0; j < distanceScales.size(); ++j) {
+		auto& thisCurve = curves[j];
+		for (auto i = 0; i < curve.size(); ++i)
+			thisCurve[i] += roundToPoint(normalDirections[i] * thisAvgRadius * distanceScales[j]);
+		if (keepStartEndPoints[0])
+			thisCurve.insert(thisCurve.begin(), curve[0]);
+		if (keepStartEndPoints[1])
+			thisCurve.push_back(curve.back());
 	}
+	if (distalPoints)
+		for (auto i = 0; i < 2; ++i)
+			if (thisDistalPoints[i] != Point())
+				(*distalPoints)[i] = thisDistalPoints[i];
+	CurveCache::Entry thisEntry;
+	thisEntry.value = thisSumOfRadii;
+	thisEntry.count = thisNTeeth;
+	thisEntry.points = thisDistalPoints;
+	thisEntry.curves = curves;
+	context.curveCache->insert(key, thisEntry);
 }
 
-void computeStringCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, float const& distanceScale, deque<bool> const& keepStartEndPoints, deque<bool> const& considerAnchorDisplacements, bool const& considerDistalPoints, vector<Point>& curve, float* const& sumOfRadii, int* const& nTeeth, vector<Point>* const& distalPoints) {
+void computeStringCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, float const& distanceScale, deque<bool> const& keepStartEndPoints, deque<bool> const& considerAnchorDisplacements, bool const& considerDistalPoints, vector<Point>& curve, float* const& sumOfRadii, int* const& nTeeth, vector<Point>* const& distalPoints) {
 	vector<vector<Point>> tmpCurves;
-	computeStringCurves(teeth, positions, {distanceScale}, keepStartEndPoints, considerAnchorDisplacements, considerDistalPoints, tmpCurves, sumOfRadii, nTeeth, distalPoints);
-	curve = tmpCurves[0];
+	computeStringCurves(context, teeth, positions, {distanceScale}, keepStartEndPoints, considerAnchorDisplacements, considerDistalPoints, tmpCurves, sumOfRadii, nTeeth, distalPoints);
+	curve = move(tmpCurves[0]);
+}
+
+void computeInscribedCurve(DesignContext const& context, vector<Point> const& cornerPoints, vector<Point>& curve, float const& smoothness, bool const& shouldAppend) {
+	auto const p0 = cornerPoints[0], p1 = cornerPoints[1], p2 = cornerPoints[2];
+	if (!shouldAppend)
+		curve.clear();
+	computeInscribedCurve(context, p0, p1, p2, curve, smoothness);
 }
 
-void computeInscribedCurve(vector<Point> const& cornerPoints, vector<Point>& curve, float const& smoothness, bool const& shouldAppend) {
-	Point2f const &v1 = cornerPoints[0] - cornerPoints[1], &v2 = cornerPoints[2] - cornerPoints[1];
+void computeInscribedCurve(DesignContext const& context, Point const& p0, Point const& p1, Point const& p2, vector<Point>& curve, float const& smoothness) {
+	Point2f const &v1 = p0 - p1, &v2 = p2 - p1;
 	auto const &l1 = norm(v1), &l2 = norm(v2);
 	auto const &d1 = v1 / l1, &d2 = v2 / l2;
 	auto const& sinTheta = d1.cross(d2);
@@ -141,53 +164,123 @@ void computeInscribedCurve(vector<Point> const& cornerPoints, vector<Point>& cur
 	if (d1.dot(d2) < 0)
 		theta = CV_PI - theta;
 	auto const& radius = static_cast<float>(min({l1, l2}) * tan(theta / 2) * smoothness);
-	vector<Point> thisCurve;
+	thread_local vector<Point> thisCurve;
 	auto const& d = sinTheta < 0 ? d1 : d2;
-	auto const& isValidCurve = EllipticCurve(cornerPoints[1] + roundToPoint(normalize(d1 + d2) * radius / sin(theta / 2)), Size(radius, radius), radianToDegree(atan2(d.x, -d.y)), 180 - radianToDegree(theta), sinTheta > 0).getCurve(thisCurve);
-	if (!shouldAppend)
-		curve.clear();
-	if (isValidCurve)
+	if (EllipticCurve(p1 + roundToPoint(normalize(d1 + d2) * radius / sin(theta / 2)), Size(radius, radius), radianToDegree(atan2(d.x, -d.y)), 180 - radianToDegree(theta), sinTheta > 0).getCurve(context, thisCurve))
 		curve.insert(curve.end(), thisCurve.begin(), thisCurve.end());
 	else
-		curve.push_back(cornerPoints[1]);
+		curve.push_back(p1);
 }
 
-void computeSmoothCurve(vector<Point> const& curve, vector<Point>& smoothCurve, bool const& isClosed, float const& smoothness) {
-	vector<Point> tmpCurve;
+void computeSmoothCurve(DesignContext const& context, vector<Point> const& curve, vector<Point>& smoothCurve, bool const& isClosed, float const& smoothness) {
+	thread_local vector<Point> tmpCurve;
+	tmpCurve.clear();
 	for (auto point = curve.begin(); point < curve.end(); ++point) {
 		auto const &isFirst = point == curve.begin(), &isLast = point == curve.end() - 1;
 		if (isClosed || !(isFirst || isLast))
-			computeInscribedCurve({isFirst ? curve.back() : *(point - 1), *point, isLast ? curve[0] : *(point + 1)}, tmpCurve, smoothness);
+			computeInscribedCurve(context, isFirst ? curve.back() : *(point - 1), *point, isLast ? curve[0] : *(point + 1), tmpCurve, smoothness);
 		else
-			tmpCurve.insert(tmpCurve.end(), *point);
+			tmpCurve.push_back(*point);
 	}
-	smoothCurve = tmpCurve;
+	swap(smoothCurve, tmpCurve);
 }
 
-void computePiecewiseSmoothCurve(vector<Point> const& curve, vector<Point>& piecewiseSmoothCurve, bool const& smoothStart, bool const& smoothEnd) {
-	vector<vector<Point>> smoothCurves(3);
-	smoothCurves[1] = vector<Point>{curve.begin() + 2, curve.end() - 2};
+void computePiecewiseSmoothCurve(DesignContext const& context, vector<Point> const& curve, vector<Point>& piecewiseSmoothCurve, bool const& smoothStart, bool const& smoothEnd) {
+	thread_local vector<Point> smoothCurves[3];
+	for (auto i = 0; i < 3; ++i)
+		smoothCurves[i].clear();
 	if (smoothStart) {
-		computeInscribedCurve(vector<Point>{curve.begin(), curve.begin() + 3}, smoothCurves[0], 1);
-		smoothCurves[0].insert(smoothCurves[0].begin(), curve[0]);
-		smoothCurves[1].insert(smoothCurves[1].begin(), smoothCurves[0].back());
+		smoothCurves[0].push_back(curve[0]);
+		computeInscribedCurve(context, curve[0], curve[1], curve[2], smoothCurves[0], 1);
+		smoothCurves[1].push_back(smoothCurves[0].back());
 	}
 	else
-		smoothCurves[1].insert(smoothCurves[1].begin(), curve.begin(), curve.begin() + 2);
+		smoothCurves[1].insert(smoothCurves[1].end(), curve.begin(), curve.begin() + 2);
+	smoothCurves[1].insert(smoothCurves[1].end(), curve.begin() + 2, curve.end() - 2);
 	if (smoothEnd) {
-		computeInscribedCurve(vector<Point>{curve.end() - 3, curve.end()}, smoothCurves[2], 1);
+		computeInscribedCurve(context, *(curve.end() - 3), *(curve.end() - 2), curve.back(), smoothCurves[2], 1);
 		smoothCurves[2].push_back(curve.back());
 		smoothCurves[1].push_back(smoothCurves[2][0]);
 	}
 	else
 		smoothCurves[1].insert(smoothCurves[1].end(), curve.end() - 2, curve.end());
-	computeSmoothCurve(smoothCurves[1], smoothCurves[1]);
+	computeSmoothCurve(context, smoothCurves[1], smoothCurves[1]);
 	piecewiseSmoothCurve.clear();
 	for (auto i = 0; i < 3; ++i)
 		piecewiseSmoothCurve.insert(piecewiseSmoothCurve.end(), smoothCurves[i].begin(), smoothCurves[i].end());
 }
 
-void findAnchorPoints(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Rpd::Position>& startEndPositions, const vector<Point>* const& inAnchorPoints, vector<Point>* const& outAnchorPoints) {
+void fillCurve(Mat const& image, vector<Point> const& curve, Scalar const& color, Point const& offset) {
+	auto points = curve.data();
+	auto const& nPoints = static_cast<int>(curve.size());
+	fillPoly(const_cast<Mat&>(image), &points, &nPoints, 1, color, LINE_AA, 0, offset);
+}
+
+void drawCurve(DesignContext const& context, Mat const& designImage, vector<Point> const& curve, bool const& isClosed, int const& level) {
+	if (context.displayList)
+		context.displayList->addPolyline(curve, isClosed, level);
+	else
+		polylines(designImage, curve, isClosed, 0, lineThicknessOfLevel[level], LINE_AA);
+}
+
+void drawEllipse(DesignContext const& context, Mat const& designImage, Point2f const& center, Size2f const& axes, float const& angle, float const& startAngle, float const& endAngle, int const& level) {
+	if (context.displayList)
+		context.displayList->addEllipse(center, axes, angle, startAngle, endAngle, level);
+	else
+		ellipse(designImage, center, Size(axes.width, axes.height), angle, startAngle, endAngle, 0, lineThicknessOfLevel[level], LINE_AA);
+}
+
+void drawFill(DesignContext const& context, Mat const& designImage, vector<Point> const& curve, uchar const& color) {
+	if (context.displayList)
+		context.displayList->addFill(curve, color);
+	else
+		fillCurve(designImage, curve, color);
+}
+
+void drawLayer(DesignContext const& context, Mat const& designImage, vector<Point> const& curve, uchar const& color, const vector<Point>* const& hole) {
+	if (context.displayList) {
+		context.displayList->addLayer(curve, color, hole);
+		return;
+	}
+	auto roi = getLayerRect(context, designImage, curve);
+	if (hole)
+		roi |= getLayerRect(context, designImage, *hole);
+	auto const& thisDesign = getLayer(roi.size());
+	fillCurve(thisDesign, curve, color, -roi.tl());
+	if (hole) {
+		fillCurve(thisDesign, *hole, 255, -roi.tl());
+		thread_local vector<Point> thisHole;
+		thisHole.resize(hole->size());
+		for (auto i = 0; i < hole->size(); ++i)
+			thisHole[i] = (*hole)[i] - roi.tl();
+		polylines(thisDesign, thisHole, true, 0, lineThicknessOfLevel[2], LINE_AA);
+	}
+	bitwise_and(thisDesign, designImage(roi), designImage(roi));
+}
+
+void drawLine(DesignContext const& context, Mat const& designImage, Point2f const& p1, Point2f const& p2, int const& level) {
+	if (context.displayList)
+		context.displayList->addLine(p1, p2, level);
+	else
+		line(designImage, p1, p2, 0, lineThicknessOfLevel[level], LINE_AA);
+}
+
+Rect getLayerRect(DesignContext const& context, Mat const& designImage, vector<Point> const& curve) {
+	auto const& margin = lineThicknessOfLevel[2];
+	auto const& rect = boundingRect(curve);
+	return Rect(rect.x - margin, rect.y - margin, rect.width + margin * 2, rect.height + margin * 2) & Rect(Point(), designImage.size());
+}
+
+Mat getLayer(Size const& size) {
+	thread_local Mat buffer;
+	if (buffer.rows < size.height || buffer.cols < size.width)
+		buffer.create(max(buffer.rows, size.height), max(buffer.cols, size.width), CV_8U);
+	auto layer = buffer(Rect(Point(), size));
+	layer.setTo(255);
+	return layer;
+}
+
+void findAnchorPoints(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Rpd::Position>& startEndPositions, const vector<Point>* const& inAnchorPoints, vector<Point>* const& outAnchorPoints) {
 	startEndPositions = positions;
 	vector<Point> anchorPoints;
 	if (inAnchorPoints)
@@ -195,12 +288,12 @@ void findAnchorPoints(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position
 	else {
 		anchorPoints = vector<Point>(2);
 		if (startEndPositions[0].zone == startEndPositions[1].zone) {
-			if (!shouldAnchor(teeth, startEndPositions[0], Rpd::MESIAL))
+			if (!context.topology->shouldAnchor(startEndPositions[0], Rpd::MESIAL))
 				anchorPoints[0] = getTooth(teeth, startEndPositions[0]++).getAnglePoint(180);
 		}
-		else if (!shouldAnchor(teeth, startEndPositions[0], Rpd::DISTAL))
+		else if (!context.topology->shouldAnchor(startEndPositions[0], Rpd::DISTAL))
 			anchorPoints[0] = getTooth(teeth, startEndPositions[0]--).getAnglePoint(0);
-		if (!shouldAnchor(teeth, startEndPositions[1], Rpd::DISTAL)) {
+		if (!context.topology->shouldAnchor(startEndPositions[1], Rpd::DISTAL)) {
 			auto const& shouldSwap = startEndPositions[1].ordinal == 0;
 			anchorPoints[1] = getTooth(teeth, startEndPositions[1]--).getAnglePoint(0);
 			if (shouldSwap) {
@@ -213,13 +306,22 @@ void findAnchorPoints(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position
 		*outAnchorPoints = anchorPoints;
 }
 
-void computeLingualCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<vector<Point>>& curves, vector<Point>* const& distalPoints, const vector<Point>* const& anchorPoints) {
+void computeLingualCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<vector<Point>>& curves, vector<Point>* const& distalPoints, const vector<Point>* const& anchorPoints) {
+	auto const& key = CurveCache::getKey(CurveCache::LINGUAL_CURVE, positions, {}, anchorPoints);
+	auto const& entry = context.curveCache->find(key);
+	if (entry) {
+		curve = entry->curve;
+		curves.insert(curves.end(), entry->curves.begin(), entry->curves.end());
+		if (distalPoints)
+			*distalPoints = entry->points;
+		return;
+	}
+	auto const& nCurves = curves.size();
 	curve.clear();
-	if (distalPoints)
-		*distalPoints = vector<Point>(2);
+	vector<Point> thisDistalPoints(2);
 	vector<Rpd::Position> startEndPositions;
 	vector<Point> thisAnchorPoints;
-	findAnchorPoints(teeth, positions, startEndPositions, anchorPoints, &thisAnchorPoints);
+	findAnchorPoints(context, teeth, positions, startEndPositions, anchorPoints, &thisAnchorPoints);
 	if (startEndPositions[0].zone == startEndPositions[1].zone) {
 		auto dbStartPosition = startEndPositions[0];
 		while (dbStartPosition <= startEndPositions[1] && !getTooth(teeth, dbStartPosition).hasDentureBase(DentureBase::DOUBLE))
@@ -236,14 +338,14 @@ void computeLingualCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Posit
 			vector<Point> thisCurve;
 			if (considerLast || hasDistalLingualCoverage) {
 				auto const& lastPosition = --Rpd::Position(position);
-				computeStringCurve(teeth, {considerLast ? lastPosition : position, hasDistalLingualCoverage ? position : lastPosition}, -distanceScales[BYPASS], {true, true}, {false, false}, false, thisCurve);
-				computePiecewiseSmoothCurve(thisCurve, thisCurve);
+				computeStringCurve(context, teeth, {considerLast ? lastPosition : position, hasDistalLingualCoverage ? position : lastPosition}, -distanceScales[BYPASS], {true, true}, {false, false}, false, thisCurve);
+				computePiecewiseSmoothCurve(context, thisCurve, thisCurve);
 				curves.push_back(thisCurve);
 				curve.insert(curve.end(), thisCurve.begin(), thisCurve.end());
 			}
 			if (isValidPosition && !hasMesialLingualCoverage && !hasDistalLingualCoverage) {
-				thisCurve = getTooth(teeth, position).getCurve(180, 0);
-				curve.insert(curve.end(), thisCurve.rbegin(), thisCurve.rend());
+				auto const& toothCurve = getTooth(teeth, position).getCurve(180, 0);
+				curve.insert(curve.end(), toothCurve.rbegin(), toothCurve.rend());
 			}
 			considerLast = hasMesialLingualCoverage;
 		}
@@ -253,8 +355,8 @@ void computeLingualCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Posit
 			curve.push_back(thisAnchorPoints[1]);
 		else if (dbStartPosition <= startEndPositions[1]) {
 			vector<Point> dbCurve;
-			computeStringCurve(teeth, {dbStartPosition, startEndPositions[1]}, -distanceScales[DENTURE_BASE_CURVE], {true, true}, {true, true}, true, dbCurve, nullptr, nullptr, distalPoints);
-			computePiecewiseSmoothCurve(dbCurve, dbCurve);
+			computeStringCurve(context, teeth, {dbStartPosition, startEndPositions[1]}, -distanceScales[DENTURE_BASE_CURVE], {true, true}, {true, true}, true, dbCurve, nullptr, nullptr, &thisDistalPoints);
+			computePiecewiseSmoothCurve(context, dbCurve, dbCurve);
 			curve.insert(curve.end(), dbCurve.begin(), dbCurve.end());
 		}
 	}
@@ -263,71 +365,80 @@ void computeLingualCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Posit
 		vector<Rpd::Position> const& startPositions{Rpd::Position(zones[0], 0), Rpd::Position(zones[1], 0)};
 		vector<Tooth> const& startTeeth{getTooth(teeth, startPositions[0]), getTooth(teeth, startPositions[1])};
 		vector<vector<Point>> tmpCurves(2);
-		vector<Point> tmpDistalPoints(2);
+		vector<Point> tmpDistalPoints(2), tmpAnchorPoints;
 		if (startTeeth[0].hasDentureBase(DentureBase::DOUBLE) && startTeeth[1].hasDentureBase(DentureBase::DOUBLE)) {
 			auto dbPositions = startPositions;
 			for (auto i = 0; i < 2; ++i) {
 				while (getTooth(teeth, ++Rpd::Position(dbPositions[i])).hasDentureBase(DentureBase::DOUBLE))
 					++dbPositions[i];
-				computeLingualCurve(teeth, {++Rpd::Position(dbPositions[i]), startEndPositions[i]}, tmpCurves[i], curves, &tmpDistalPoints, new vector<Point>{Point(), thisAnchorPoints[i]});
-				if (distalPoints && tmpDistalPoints[1] != Point())
-					(*distalPoints)[i] = tmpDistalPoints[1];
+				tmpAnchorPoints = {Point(), thisAnchorPoints[i]};
+				computeLingualCurve(context, teeth, {++Rpd::Position(dbPositions[i]), startEndPositions[i]}, tmpCurves[i], curves, &tmpDistalPoints, &tmpAnchorPoints);
+				if (tmpDistalPoints[1] != Point())
+					thisDistalPoints[i] = tmpDistalPoints[1];
 			}
-			computeStringCurve(teeth, {dbPositions[0], dbPositions[1]}, -distanceScales[DENTURE_BASE_CURVE], {true, true}, {true, true}, true, curve, nullptr, nullptr, &tmpDistalPoints);
-			if (distalPoints)
-				for (auto i = 0; i < 2; ++i)
-					if (tmpDistalPoints[i] != Point())
-						(*distalPoints)[i] = tmpDistalPoints[i];
-			computePiecewiseSmoothCurve(curve, curve);
+			computeStringCurve(context, teeth, {dbPositions[0], dbPositions[1]}, -distanceScales[DENTURE_BASE_CURVE], {true, true}, {true, true}, true, curve, nullptr, nullptr, &tmpDistalPoints);
+			for (auto i = 0; i < 2; ++i)
+				if (tmpDistalPoints[i] != Point())
+					thisDistalPoints[i] = tmpDistalPoints[i];
+			computePiecewiseSmoothCurve(context, curve, curve);
 			curve.insert(curve.begin(), tmpCurves[0].rbegin(), tmpCurves[0].rend());
 			curve.insert(curve.end(), tmpCurves[1].begin(), tmpCurves[1].end());
 		}
 		else if (startTeeth[0].hasLingualCoverage(Rpd::DISTAL) && startTeeth[1].hasLingualCoverage(Rpd::DISTAL)) {
 			for (auto i = 0; i < 2; ++i) {
-				computeLingualCurve(teeth, {Rpd::Position(zones[i], 1), startEndPositions[i]}, tmpCurves[i], curves, &tmpDistalPoints, new vector<Point>{Point(), thisAnchorPoints[i]});
-				if (distalPoints && tmpDistalPoints[1] != Point())
-					(*distalPoints)[i] = tmpDistalPoints[1];
+				tmpAnchorPoints = {Point(), thisAnchorPoints[i]};
+				computeLingualCurve(context, teeth, {Rpd::Position(zones[i], 1), startEndPositions[i]}, tmpCurves[i], curves, &tmpDistalPoints, &tmpAnchorPoints);
+				if (tmpDistalPoints[1] != Point())
+					thisDistalPoints[i] = tmpDistalPoints[1];
 			}
-			computeStringCurve(teeth, {startPositions[0], startPositions[1]}, -distanceScales[BYPASS], {true, true}, {false, false}, false, curve);
-			computePiecewiseSmoothCurve(curve, curve);
+			computeStringCurve(context, teeth, {startPositions[0], startPositions[1]}, -distanceScales[BYPASS], {true, true}, {false, false}, false, curve);
+			computePiecewiseSmoothCurve(context, curve, curve);
 			curves.push_back(curve);
 			curve.insert(curve.begin(), tmpCurves[0].rbegin(), tmpCurves[0].rend());
 			curve.insert(curve.end(), tmpCurves[1].begin(), tmpCurves[1].end());
 		}
 		else {
 			for (auto i = 0; i < 2; ++i) {
-				computeLingualCurve(teeth, {startPositions[i], startEndPositions[i]}, tmpCurves[i], curves, &tmpDistalPoints, new vector<Point>{Point(), thisAnchorPoints[i]});
-				if (distalPoints && tmpDistalPoints[1] != Point())
-					(*distalPoints)[i] = tmpDistalPoints[1];
+				tmpAnchorPoints = {Point(), thisAnchorPoints[i]};
+				computeLingualCurve(context, teeth, {startPositions[i], startEndPositions[i]}, tmpCurves[i], curves, &tmpDistalPoints, &tmpAnchorPoints);
+				if (tmpDistalPoints[1] != Point())
+					thisDistalPoints[i] = tmpDistalPoints[1];
 			}
 			curve.insert(curve.end(), tmpCurves[0].rbegin(), tmpCurves[0].rend());
 			curve.insert(curve.end(), tmpCurves[1].begin(), tmpCurves[1].end());
 		}
 	}
+	if (distalPoints)
+		*distalPoints = thisDistalPoints;
+	CurveCache::Entry thisEntry;
+	thisEntry.curve = curve;
+	thisEntry.points = thisDistalPoints;
+	thisEntry.curves.assign(curves.begin() + nCurves, curves.end());
+	context.curveCache->insert(key, thisEntry);
 }
 
-void computeLingualCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<vector<Point>>& curves, Point& distalPoint, const vector<Point>* const& anchorPoints) {
+void computeLingualCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<vector<Point>>& curves, Point& distalPoint, const vector<Point>* const& anchorPoints) {
 	vector<Point> distalPoints;
-	computeLingualCurve(teeth, positions, curve, curves, &distalPoints, anchorPoints);
+	computeLingualCurve(context, teeth, positions, curve, curves, &distalPoints, anchorPoints);
 	if (distalPoints.size())
 		distalPoint = distalPoints[1];
 }
 
-void computeMesialCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<Point>* const& innerCurve) {
+void computeMesialCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<Point>* const& innerCurve) {
 	auto startPositions = positions;
 	for (auto i = 0; i < 2; ++i)
-		if (!shouldAnchor(teeth, startPositions[i], Rpd::MESIAL))
+		if (!context.topology->shouldAnchor(startPositions[i], Rpd::MESIAL))
 			++startPositions[i];
 	auto const& ordinal = max(startPositions[0].ordinal, startPositions[1].ordinal);
 	vector<vector<Point>> curves(2);
 	float sumOfRadii = 0;
 	auto nTeeth = 0;
 	for (auto i = 0; i < 2; ++i)
-		computeStringCurve(teeth, {startPositions[i], Rpd::Position(positions[i].zone, ordinal)}, 0, {true, false}, {true, false}, false, curves[i], &sumOfRadii, &nTeeth);
+		computeStringCurve(context, teeth, {startPositions[i], Rpd::Position(positions[i].zone, ordinal)}, 0, {true, false}, {true, false}, false, curves[i], &sumOfRadii, &nTeeth);
 	auto const& avgRadius = sumOfRadii / nTeeth;
 	for (auto i = 0; i < 2; ++i)
 		for (auto point = curves[i].begin() + 1; point < curves[i].end(); ++point)
-			*point -= roundToPoint(computeNormalDirection(*point) * avgRadius * distanceScales[MESIAL_OR_DISTAL]);
+			*point -= roundToPoint(computeNormalDirection(context, *point) * avgRadius * distanceScales[MESIAL_OR_DISTAL]);
 	if (innerCurve) {
 		innerCurve->clear();
 		innerCurve->push_back(*(curves[0].end() - 2));
@@ -337,20 +448,20 @@ void computeMesialCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positi
 	curve = vector<Point>{curves[0].begin(), curves[0].end() - 2};
 	curve.push_back((*(curves[0].end() - 2) + *(curves[1].end() - 2)) / 2);
 	curve.insert(curve.end(), curves[1].rbegin() + 2, curves[1].rend());
-	computeSmoothCurve(curve, curve);
+	computeSmoothCurve(context, curve, curve);
 }
 
-void computeDistalCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point> const& distalPoints, vector<Point>& curve, vector<Point>* const& innerCurve) {
+void computeDistalCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point> const& distalPoints, vector<Point>& curve, vector<Point>* const& innerCurve) {
 	auto endPositions = positions;
 	for (auto i = 0; i < 2; ++i)
-		if (!shouldAnchor(teeth, endPositions[i], Rpd::DISTAL))
+		if (!context.topology->shouldAnchor(endPositions[i], Rpd::DISTAL))
 			--endPositions[i];
 	auto const& ordinal = min(endPositions[0].ordinal, endPositions[1].ordinal);
 	vector<vector<Point>> curves(2);
 	float sumOfRadii = 0;
 	auto nTeeth = 0;
 	for (auto i = 0; i < 2; ++i) {
-		computeStringCurve(teeth, {Rpd::Position(positions[i].zone, ordinal), endPositions[i]}, 0, {false, false}, {false, true}, false, curves[i], &sumOfRadii, &nTeeth);
+		computeStringCurve(context, teeth, {Rpd::Position(positions[i].zone, ordinal), endPositions[i]}, 0, {false, false}, {false, true}, false, curves[i], &sumOfRadii, &nTeeth);
 		if (distalPoints[i] != Point())
 			curves[i].back() = distalPoints[i];
 		curves[i].push_back(curves[i].back());
@@ -358,25 +469,34 @@ void computeDistalCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positi
 	auto const& avgRadius = sumOfRadii / nTeeth;
 	for (auto i = 0; i < 2; ++i)
 		for (auto point = curves[i].begin(); point < curves[i].end() - 1; ++point)
-			*point -= roundToPoint(computeNormalDirection(*point) * avgRadius * distanceScales[MESIAL_OR_DISTAL]);
+			*point -= roundToPoint(computeNormalDirection(context, *point) * avgRadius * distanceScales[MESIAL_OR_DISTAL]);
 	if (innerCurve) {
 		innerCurve->push_back((innerCurve->back() + curves[0][1]) / 2);
 		innerCurve->push_back(curves[0][1]);
 		innerCurve->push_back((curves[0][0] + curves[1][0]) / 2);
 		innerCurve->push_back(curves[1][1]);
 		innerCurve->push_back((curves[1][1] + (*innerCurve)[0]) / 2);
-		computeSmoothCurve(*innerCurve, *innerCurve, true);
+		computeSmoothCurve(context, *innerCurve, *innerCurve, true);
 	}
 	curve = vector<Point>{curves[0].rbegin(), curves[0].rend() - 2};
 	curve.push_back((curves[0][1] + curves[1][1]) / 2);
 	curve.insert(curve.end(), curves[1].begin() + 2, curves[1].end());
-	computeSmoothCurve(curve, curve);
+	computeSmoothCurve(context, curve, curve);
 }
 
-void computeInnerCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, float const& avgRadius, vector<Point>& curve, vector<vector<Point>>& curves, const vector<Point>* const& anchorPoints) {
+void computeInnerCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, float const& avgRadius, vector<Point>& curve, vector<vector<Point>>& curves, const vector<Point>* const& anchorPoints) {
+	auto const& key = CurveCache::getKey(CurveCache::INNER_CURVE, positions, {avgRadius}, anchorPoints);
+	auto const& entry = context.curveCache->find(key);
+	if (entry) {
+		curve.insert(curve.end(), entry->curve.begin(), entry->curve.end());
+		curves.insert(curves.end(), entry->curves.begin(), entry->curves.end());
+		return;
+	}
+	auto const& nPoints = curve.size();
+	auto const& nCurves = curves.size();
 	vector<Rpd::Position> startEndPositions;
 	vector<Point> thisAnchorPoints, tmpCurve;
-	findAnchorPoints(teeth, positions, startEndPositions, anchorPoints, &thisAnchorPoints);
+	findAnchorPoints(context, teeth, positions, startEndPositions, anchorPoints, &thisAnchorPoints);
 	if (startEndPositions[0].zone == startEndPositions[1].zone) {
 		auto const& zone = startEndPositions[0].zone;
 		auto const& startOrdinal = startEndPositions[0].ordinal;
@@ -409,7 +529,7 @@ void computeInnerCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positio
 				}
 				auto hasCurve = true;
 				if (lastPosition.zone == thisPosition.zone && lastPosition.ordinal <= thisPosition.ordinal) {
-					computeStringCurve(teeth, {lastPosition, thisPosition}, 0, {false, false}, {false, false}, false, tmpCurve);
+					computeStringCurve(context, teeth, {lastPosition, thisPosition}, 0, {false, false}, {false, false}, false, tmpCurve);
 					if (lastAnchorPoint != Point())
 						tmpCurve[0] = lastAnchorPoint;
 					tmpCurve.insert(tmpCurve.begin(), tmpCurve[0]);
@@ -417,8 +537,8 @@ void computeInnerCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positio
 						tmpCurve.back() = thisAchorPoint;
 					tmpCurve.push_back(tmpCurve.back());
 					for (auto i = 1; i < tmpCurve.size() - 1; ++i)
-						tmpCurve[i] -= roundToPoint(computeNormalDirection(tmpCurve[i]) * avgRadius * distanceScales[INNER]);
-					computePiecewiseSmoothCurve(tmpCurve, tmpCurve, isStart, isEnd);
+						tmpCurve[i] -= roundToPoint(computeNormalDirection(context, tmpCurve[i]) * avgRadius * distanceScales[INNER]);
+					computePiecewiseSmoothCurve(context, tmpCurve, tmpCurve, isStart, isEnd);
 				}
 				else if (lastAnchorPoint != Point() && thisAchorPoint != Point())
 					tmpCurve = {lastAnchorPoint, thisAchorPoint};
@@ -434,8 +554,8 @@ void computeInnerCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positio
 					auto thisStartOrdinal = curOrdinal;
 					while (curOrdinal < endOrdinal) {
 						auto& thisTooth = getTooth(teeth, Rpd::Position(zone, curOrdinal + 1));
-						auto& thisHasLingualConfrontation = thisTooth.hasLingualConfrontation();
-						auto& thisHasSingleDb = thisTooth.hasDentureBase(DentureBase::SINGLE);
+						auto const& thisHasLingualConfrontation = thisTooth.hasLingualConfrontation();
+						auto const& thisHasSingleDb = thisTooth.hasDentureBase(DentureBase::SINGLE);
 						auto const& thisHasClaspRootOrRest = thisTooth.hasClaspRootOrRest(Rpd::MESIAL) || thisTooth.hasClaspRootOrRest(Rpd::DISTAL);
 						if (!hasLingualConfrontation && !hasSingleDb && !thisHasLingualConfrontation && !thisHasSingleDb && !thisHasClaspRootOrRest || hasSingleDb && thisHasSingleDb || hasLingualConfrontation && thisHasLingualConfrontation)
 							++curOrdinal;
@@ -468,37 +588,39 @@ void computeInnerCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positio
 		auto hasLingualConfrontation = true, hasSingleDb = true, hasNone = true;
 		for (auto i = 0; i < 2; ++i) {
 			auto& tooth = getTooth(teeth, Rpd::Position(startEndPositions[i].zone, 0));
-			auto& thisHasLingualConfrontation = tooth.hasLingualConfrontation();
-			auto& thisHasSingleDb = tooth.hasDentureBase(DentureBase::SINGLE);
+			auto const& thisHasLingualConfrontation = tooth.hasLingualConfrontation();
+			auto const& thisHasSingleDb = tooth.hasDentureBase(DentureBase::SINGLE);
 			hasLingualConfrontation &= thisHasLingualConfrontation;
 			hasSingleDb &= thisHasSingleDb;
 			hasNone &= !thisHasLingualConfrontation && !thisHasSingleDb && !tooth.hasClaspRootOrRest(Rpd::MESIAL);
 		}
 		auto startPositions = startEndPositions;
 		vector<vector<Point>> thisCurves(2);
-		vector<Point> tmpPoints(2);
+		vector<Point> tmpPoints(2), tmpAnchorPoints;
 		for (auto i = 0; i < 2; ++i) {
 			startPositions[i].ordinal = 0;
 			if (hasLingualConfrontation || hasSingleDb || hasNone) {
 				auto hasDistalClaspRootOrRest = getTooth(teeth, startPositions[i]).hasClaspRootOrRest(Rpd::DISTAL);
 				while (startPositions[i] < startEndPositions[i]) {
 					auto& thisTooth = getTooth(teeth, ++Rpd::Position(startPositions[i]));
-					auto& thisHasLingualConfrontation = thisTooth.hasLingualConfrontation();
-					auto& thisHasSingleDb = thisTooth.hasDentureBase(DentureBase::SINGLE);
-					auto& thisHasMesialClaspRootOrRest = thisTooth.hasClaspRootOrRest(Rpd::MESIAL);
+					auto const& thisHasLingualConfrontation = thisTooth.hasLingualConfrontation();
+					auto const& thisHasSingleDb = thisTooth.hasDentureBase(DentureBase::SINGLE);
+					auto const& thisHasMesialClaspRootOrRest = thisTooth.hasClaspRootOrRest(Rpd::MESIAL);
 					if (hasNone && !hasDistalClaspRootOrRest && !thisHasLingualConfrontation && !thisHasSingleDb && !thisHasMesialClaspRootOrRest || hasSingleDb && thisHasSingleDb || hasLingualConfrontation && thisHasLingualConfrontation)
 						hasDistalClaspRootOrRest = getTooth(teeth, ++startPositions[i]).hasClaspRootOrRest(Rpd::DISTAL);
 					else
 						break;
 				}
 				auto const& thisStartPosition = ++Rpd::Position(startPositions[i]);
-				computeInnerCurve(teeth, {thisStartPosition, startEndPositions[i]}, avgRadius, thisCurves[i], curves, new vector<Point>{hasNone && !hasDistalClaspRootOrRest ? Point() : getTooth(teeth, startPositions[i]).getAnglePoint(180) , thisAnchorPoints[i]});
+				tmpAnchorPoints = {hasNone && !hasDistalClaspRootOrRest ? Point() : getTooth(teeth, startPositions[i]).getAnglePoint(180), thisAnchorPoints[i]};
+				computeInnerCurve(context, teeth, {thisStartPosition, startEndPositions[i]}, avgRadius, thisCurves[i], curves, &tmpAnchorPoints);
 				if (hasNone && !hasDistalClaspRootOrRest)
 					tmpPoints[i] = getTooth(teeth, thisStartPosition).getAnglePoint(0);
 			}
 			else {
 				auto &tooth = getTooth(teeth, startPositions[i]), &nextTooth = getTooth(teeth, --Rpd::Position(startPositions[i]));
-				computeInnerCurve(teeth, {startPositions[i], startEndPositions[i]}, avgRadius, thisCurves[i], curves, new vector<Point>{(nextTooth.hasLingualConfrontation() || nextTooth.hasDentureBase(DentureBase::SINGLE) || nextTooth.hasClaspRootOrRest(Rpd::MESIAL)) && (i == 0 || !(tooth.hasLingualConfrontation() || tooth.hasDentureBase(DentureBase::SINGLE) || tooth.hasClaspRootOrRest(Rpd::MESIAL))) ? nextTooth.getAnglePoint(0) : Point(), thisAnchorPoints[i]});
+				tmpAnchorPoints = {(nextTooth.hasLingualConfrontation() || nextTooth.hasDentureBase(DentureBase::SINGLE) || nextTooth.hasClaspRootOrRest(Rpd::MESIAL)) && (i == 0 || !(tooth.hasLingualConfrontation() || tooth.hasDentureBase(DentureBase::SINGLE) || tooth.hasClaspRootOrRest(Rpd::MESIAL))) ? nextTooth.getAnglePoint(0) : Point(), thisAnchorPoints[i]};
+				computeInnerCurve(context, teeth, {startPositions[i], startEndPositions[i]}, avgRadius, thisCurves[i], curves, &tmpAnchorPoints);
 			}
 		}
 		curve.insert(curve.end(), thisCurves[0].rbegin(), thisCurves[0].rend());
@@ -512,31 +634,43 @@ void computeInnerCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positio
 			curve.insert(curve.end(), tmpCurve.begin(), tmpCurve.end());
 		}
 		else if (hasNone) {
-			computeStringCurve(teeth, startPositions, 0, {true, true}, {false, false}, false, tmpCurve);
+			computeStringCurve(context, teeth, startPositions, 0, {true, true}, {false, false}, false, tmpCurve);
 			if (tmpPoints[0] != Point())
 				tmpCurve[0] = tmpPoints[0];
 			if (tmpPoints[1] != Point())
 				tmpCurve.back() = tmpPoints[1];
 			for (auto i = 1; i < tmpCurve.size() - 1; ++i)
-				tmpCurve[i] -= roundToPoint(computeNormalDirection(tmpCurve[i]) * avgRadius * distanceScales[INNER]);
+				tmpCurve[i] -= roundToPoint(computeNormalDirection(context, tmpCurve[i]) * avgRadius * distanceScales[INNER]);
 			deque<bool> isStartEnds(2);
 			for (auto i = 0; i < 2; ++i)
 				isStartEnds[i] = startPositions[i] == startEndPositions[i];
-			computePiecewiseSmoothCurve(tmpCurve, tmpCurve, isStartEnds[0], isStartEnds[1]);
+			computePiecewiseSmoothCurve(context, tmpCurve, tmpCurve, isStartEnds[0], isStartEnds[1]);
 			curve.insert(curve.end(), tmpCurve.begin(), tmpCurve.end());
 			curves.push_back(tmpCurve);
 		}
 		curve.insert(curve.end(), thisCurves[1].begin(), thisCurves[1].end());
 	}
+	CurveCache::Entry thisEntry;
+	thisEntry.curve.assign(curve.begin() + nPoints, curve.end());
+	thisEntry.curves.assign(curves.begin() + nCurves, curves.end());
+	context.curveCache->insert(key, thisEntry);
 }
 
-void computeOuterCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, float* const& avgRadius) {
+void computeOuterCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, float* const& avgRadius) {
+	auto const& key = CurveCache::getKey(CurveCache::OUTER_CURVE, positions, {static_cast<float>(avgRadius != nullptr)});
+	auto const& entry = context.curveCache->find(key);
+	if (entry) {
+		curve = entry->curve;
+		if (avgRadius)
+			*avgRadius = entry->value;
+		return;
+	}
 	vector<Rpd::Position> startEndPositions;
-	findAnchorPoints(teeth, positions, startEndPositions);
+	findAnchorPoints(context, teeth, positions, startEndPositions);
 	vector<Point> dbCurve1, dbCurve2;
 	float sumOfRadii = 0;
 	auto nTeeth = 0;
-	computeStringCurve(teeth, startEndPositions, -distanceScales[OUTER], {true, true}, {true, true}, false, curve, &sumOfRadii, &nTeeth);
+	computeStringCurve(context, teeth, startEndPositions, -distanceScales[OUTER], {true, true}, {true, true}, false, curve, &sumOfRadii, &nTeeth);
 	auto thisAvgRadius = sumOfRadii / nTeeth;
 	if (avgRadius)
 		*avgRadius = thisAvgRadius;
@@ -545,31 +679,23 @@ void computeOuterCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positio
 	isInSameZone ? --dbPosition : ++dbPosition;
 	sumOfRadii = nTeeth = 0;
 	auto position = dbPosition;
-	if (isInSameZone && startEndPositions[0].ordinal > 0)
-		while (position.ordinal >= 0) {
-			auto& tooth = getTooth(teeth, position);
-			if (tooth.hasDentureBase(DentureBase::DOUBLE)) {
-				sumOfRadii += tooth.getRadius();
-				++nTeeth;
-				--position.ordinal;
-			}
-			else
-				break;
+	if (isInSameZone && startEndPositions[0].ordinal > 0) {
+		nTeeth = context.topology->countDentureBases(position, Rpd::MESIAL);
+		if (nTeeth > 0) {
+			sumOfRadii = context.topology->getSumOfRadii(Rpd::Position(position.zone, position.ordinal - nTeeth + 1), position);
+			position.ordinal -= nTeeth;
 		}
+	}
 	auto const& flag = position.ordinal < 0;
 	if (flag)
 		--++position;
-	if (!isInSameZone || startEndPositions[0].ordinal == 0 || flag)
-		while (!isLastTooth(--Rpd::Position(position))) {
-			auto& tooth = getTooth(teeth, position);
-			if (tooth.hasDentureBase(DentureBase::DOUBLE)) {
-				sumOfRadii += tooth.getRadius();
-				++nTeeth;
-				++position;
-			}
-			else
-				break;
+	if (!isInSameZone || startEndPositions[0].ordinal == 0 || flag) {
+		auto const& nDentureBases = context.topology->countDentureBases(position, Rpd::DISTAL);
+		if (nDentureBases > 0) {
+			sumOfRadii += context.topology->getSumOfRadii(position, Rpd::Position(position.zone, position.ordinal + nDentureBases - 1));
+			nTeeth += nDentureBases;
 		}
+	}
 	if (nTeeth > 0) {
 		thisAvgRadius = sumOfRadii / nTeeth;
 		auto& tooth = getTooth(teeth, dbPosition);
@@ -577,8 +703,8 @@ void computeOuterCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positio
 		auto tmpPoint = dbCurve1[0];
 		dbCurve1.insert(dbCurve1.begin(), tmpPoint);
 		for (auto i = 1; i < 3; ++i)
-			dbCurve1[i] -= roundToPoint(computeNormalDirection(dbCurve1[i]) * thisAvgRadius * distanceScales[DENTURE_BASE_CURVE]);
-		computeInscribedCurve(dbCurve1, dbCurve1, 1, false);
+			dbCurve1[i] -= roundToPoint(computeNormalDirection(context, dbCurve1[i]) * thisAvgRadius * distanceScales[DENTURE_BASE_CURVE]);
+		computeInscribedCurve(context, dbCurve1, dbCurve1, 1, false);
 		dbCurve1.insert(dbCurve1.begin(), tmpPoint);
 		if (avgRadius)
 			dbCurve1.insert(dbCurve1.begin(), curve[0]);
@@ -586,42 +712,37 @@ void computeOuterCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Positio
 		curve.erase(curve.begin() + 1);
 	}
 	dbPosition = ++Rpd::Position(startEndPositions[1]);
-	sumOfRadii = nTeeth = 0;
-	position = dbPosition;
-	while (!isLastTooth(--Rpd::Position(position))) {
-		auto& tooth = getTooth(teeth, position);
-		if (tooth.hasDentureBase(DentureBase::DOUBLE)) {
-			sumOfRadii += tooth.getRadius();
-			++nTeeth;
-			++position;
-		}
-		else
-			break;
-	}
+	nTeeth = context.topology->countDentureBases(dbPosition, Rpd::DISTAL);
 	if (nTeeth > 0) {
+		sumOfRadii = context.topology->getSumOfRadii(dbPosition, Rpd::Position(dbPosition.zone, dbPosition.ordinal + nTeeth - 1));
 		thisAvgRadius = sumOfRadii / nTeeth;
 		auto& tooth = getTooth(teeth, dbPosition);
 		dbCurve2 = {tooth.getCentroid(), tooth.getAnglePoint(0)};
 		auto tmpPoint = dbCurve2.back();
 		dbCurve2.push_back(tmpPoint);
 		for (auto i = 0; i < 2; ++i)
-			dbCurve2[i] -= roundToPoint(computeNormalDirection(dbCurve2[i]) * thisAvgRadius * distanceScales[DENTURE_BASE_CURVE]);
-		computeInscribedCurve(dbCurve2, dbCurve2, 1, false);
+			dbCurve2[i] -= roundToPoint(computeNormalDirection(context, dbCurve2[i]) * thisAvgRadius * distanceScales[DENTURE_BASE_CURVE]);
+		computeInscribedCurve(context, dbCurve2, dbCurve2, 1, false);
 		dbCurve2.push_back(tmpPoint);
 		if (avgRadius)
 			dbCurve2.push_back(curve.back());
 		curve.back() = dbCurve2[0];
 		curve.erase(curve.end() - 2);
 	}
-	computeSmoothCurve(curve, curve);
+	computeSmoothCurve(context, curve, curve);
 	curve.insert(curve.begin(), dbCurve1.begin(), dbCurve1.end());
 	curve.insert(curve.end(), dbCurve2.begin(), dbCurve2.end());
+	CurveCache::Entry thisEntry;
+	if (avgRadius)
+		thisEntry.value = *avgRadius;
+	thisEntry.curve = curve;
+	context.curveCache->insert(key, thisEntry);
 }
 
 void computeLingualConfrontationCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve) {
 	if (positions[0].zone == positions[1].zone)
 		for (auto position = positions[0]; position <= positions[1]; ++position) {
-			auto thisCurve = getTooth(teeth, position).getCurve(180, 0);
+			auto const& thisCurve = getTooth(teeth, position).getCurve(180, 0);
 			curve.insert(curve.end(), thisCurve.rbegin(), thisCurve.rend());
 		}
 	else {
@@ -672,8 +793,8 @@ void computeLingualConfrontationCurves(const vector<Tooth> (&teeth)[nZones], vec
 	}
 }
 
-Point2f computeNormalDirection(Point2f const& point, float* const& angle) {
-	auto const& curTeethEllipse = remedyImage ? remediedTeethEllipse : teethEllipse;
+Point2f computeNormalDirection(DesignContext const& context, Point2f const& point, float* const& angle) {
+	auto const& curTeethEllipse = context.getTeethEllipse();
 	auto const& direction = point - curTeethEllipse.center;
 	auto thisAngle = atan2(direction.y, direction.x) - degreeToRadian(curTeethEllipse.angle);
 	if (thisAngle < -CV_PI)
@@ -684,18 +805,34 @@ Point2f computeNormalDirection(Point2f const& point, float* const& angle) {
 	return normalDirection / norm(normalDirection);
 }
 
-bool shouldAnchor(const vector<Tooth> (&teeth)[nZones], Rpd::Position const& position, Rpd::Direction const& direction) {
+void computeNormalDirections(DesignContext const& context, vector<Point> const& points, vector<Point2f>& normalDirections) {
+	auto const& curTeethEllipse = context.getTeethEllipse();
+	auto const& ellipseAngle = degreeToRadian(curTeethEllipse.angle);
+	auto const& cosAngle = cos(ellipseAngle), sinAngle = sin(ellipseAngle);
+	auto const& xScale = curTeethEllipse.size.height * curTeethEllipse.size.height, yScale = curTeethEllipse.size.width * curTeethEllipse.size.width;
+	auto const& nPoints = points.size();
+	normalDirections.resize(nPoints);
+	for (auto i = 0; i < nPoints; ++i) {
+		auto const& dx = points[i].x - curTeethEllipse.center.x, dy = points[i].y - curTeethEllipse.center.y;
+		auto const& isCenter = dx == 0 && dy == 0;
+		auto const& x = xScale * (isCenter ? cosAngle : dx * cosAngle + dy * sinAngle), y = yScale * (isCenter ? -sinAngle : dy * cosAngle - dx * sinAngle);
+		auto const& length = sqrt(x * x + y * y);
+		normalDirections[i] = Point2f(x / length, y / length);
+	}
+}
+
+bool shouldAnchor(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], Rpd::Position const& position, Rpd::Direction const& direction) {
 	auto& tooth = getTooth(teeth, position);
 	if (tooth.hasClaspRootOrRest(direction) || tooth.expectDentureBaseAnchor(direction) || tooth.hasLingualConfrontation())
 		return true;
 	if (direction == Rpd::MESIAL)
 		return getTooth(teeth, --Rpd::Position(position)).expectDentureBaseAnchor(position.ordinal ? Rpd::DISTAL : Rpd::MESIAL);
-	return !isLastTooth(position) && getTooth(teeth, ++Rpd::Position(position)).expectDentureBaseAnchor(Rpd::MESIAL);
+	return !isLastTooth(context, position) && getTooth(teeth, ++Rpd::Position(position)).expectDentureBaseAnchor(Rpd::MESIAL);
 }
 
-bool isLastTooth(Rpd::Position const& position) { return position.ordinal == nTeethPerZone + Tooth::isEighthUsed[position.zone] - 2; }
+bool isLastTooth(DesignContext const& context, Rpd::Position const& position) { return position.ordinal == nTeethPerZone + context.isEighthUsed[position.zone] - 2; }
 
-bool queryRpds(JNIEnv* const& env, jobject const& ontModel, vector<Rpd*>& rpds) {
+bool queryRpds(DesignContext& context, JNIEnv* const& env, jobject const& ontModel, vector<Rpd*>& rpds) {
 	auto const& clsStrExtendedIterator = "org/apache/jena/util/iterator/ExtendedIterator";
 	auto const& clsStrIndividual = "org/apache/jena/ontology/Individual";
 	auto const& clsStrIterator = "java/util/Iterator";
@@ -836,36 +973,118 @@ bool queryRpds(JNIEnv* const& env, jobject const& ontModel, vector<Rpd*>& rpds)
 	}
 	if (isValid) {
 		rpds = thisRpds;
-		copy(begin(thisIsEighthToothUsed), end(thisIsEighthToothUsed), Tooth::isEighthUsed);
+		copy(begin(thisIsEighthToothUsed), end(thisIsEighthToothUsed), context.isEighthUsed);
 	}
 	return isValid;
 }
 
-void analyzeBaseImage(Mat const& base, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones], Mat (*const& designImages)[2], Mat* const& baseImage) {
-	Mat thisBaseImage;
-	copyMakeBorder(base, thisBaseImage, 80, 80, 80, 80, BORDER_CONSTANT, Scalar::all(255));
-	if (baseImage)
-		*baseImage = thisBaseImage;
-	Mat tmpImage;
-	cvtColor(thisBaseImage, tmpImage, COLOR_BGR2GRAY);
-	threshold(tmpImage, tmpImage, 0, 255, THRESH_BINARY | THRESH_OTSU);
+int getEnclosingLabel(Mat const& labels, Mat const& stats, int const& label, Mat const& outerLabels) {
+	auto const& x = stats.at<int>(label, CC_STAT_LEFT);
+	if (!x)
+		return -1;
+	auto y = stats.at<int>(label, CC_STAT_TOP);
+	while (labels.at<int>(y, x) != label)
+		++y;
+	return outerLabels.at<int>(y, x - 1);
+}
+
+void findToothContours(Mat const& image, vector<vector<Point>>& toothContours, SegmentationBackend const& backend) {
+	Mat grayImage, tmpImage;
 	vector<vector<Point>> contours;
-	vector<Tooth> tmpTeeth;
 	vector<Vec4i> hierarchy;
+	cvtColor(image, grayImage, COLOR_BGR2GRAY);
+	auto const& scale = (max(image.cols, image.rows) + maxSegmentationSide - 1) / maxSegmentationSide;
+	auto const& imageRect = Rect(Point(), image.size());
+	toothContours.clear();
+	if (backend == CONNECTED_COMPONENTS) {
+		Mat labels, stats, centroids, holeImage, holeLabels, holeStats;
+		threshold(grayImage, tmpImage, 0, 255, THRESH_BINARY | THRESH_OTSU);
+		bitwise_not(tmpImage, holeImage);
+		auto const& nLabels = connectedComponentsWithStats(tmpImage, labels, stats, centroids, 8, CV_32S);
+		connectedComponentsWithStats(holeImage, holeLabels, holeStats, centroids, 4, CV_32S);
+		auto const& backgroundLabel = labels.at<int>(0, 0);
+		for (auto label = 1; label < nLabels; ++label) {
+			if (label == backgroundLabel)
+				continue;
+			auto const& holeLabel = getEnclosingLabel(labels, stats, label, holeLabels);
+			if (holeLabel <= 0 || getEnclosingLabel(holeLabels, holeStats, holeLabel, labels) != backgroundLabel)
+				continue;
+			auto const& roi = Rect(stats.at<int>(label, CC_STAT_LEFT) - 1, stats.at<int>(label, CC_STAT_TOP) - 1, stats.at<int>(label, CC_STAT_WIDTH) + 2, stats.at<int>(label, CC_STAT_HEIGHT) + 2) & imageRect;
+			tmpImage = labels(roi) == label;
+			findContours(tmpImage, contours, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE, roi.tl());
+			toothContours.push_back(contours[0]);
+		}
+		return;
+	}
+	if (scale <= 1) {
+		threshold(grayImage, tmpImage, 0, 255, THRESH_BINARY | THRESH_OTSU);
+		findContours(tmpImage, contours, hierarchy, RETR_TREE, CHAIN_APPROX_SIMPLE);
+		for (auto i = hierarchy[0][2]; i >= 0; i = hierarchy[i][0])
+			for (auto j = hierarchy[i][2]; j >= 0; j = hierarchy[j][0])
+				toothContours.push_back(contours[j]);
+		return;
+	}
+	erode(grayImage, tmpImage, getStructuringElement(MORPH_RECT, Size(scale, scale), Point(0, 0)));
+	resize(tmpImage, tmpImage, Size(), 1.0 / scale, 1.0 / scale, INTER_NEAREST);
+	auto const& thresholdValue = threshold(tmpImage, tmpImage, 0, 255, THRESH_BINARY | THRESH_OTSU);
 	findContours(tmpImage, contours, hierarchy, RETR_TREE, CHAIN_APPROX_SIMPLE);
 	for (auto i = hierarchy[0][2]; i >= 0; i = hierarchy[i][0])
-		for (auto j = hierarchy[i][2]; j >= 0; j = hierarchy[j][0])
-			tmpTeeth.push_back(Tooth(contours[j]));
+		for (auto j = hierarchy[i][2]; j >= 0; j = hierarchy[j][0]) {
+			auto const& moment = moments(contours[j]);
+			if (moment.m00 <= 0)
+				continue;
+			auto const& coarseRect = boundingRect(contours[j]);
+			auto const& roi = Rect(coarseRect.tl() * scale, coarseRect.br() * scale) + Point(-2 * scale, -2 * scale) + Size(4 * scale, 4 * scale) & imageRect;
+			auto const& seed = Point2f(moment.m10 / moment.m00, moment.m01 / moment.m00) * static_cast<float>(scale);
+			vector<vector<Point>> roiContours;
+			vector<Vec4i> roiHierarchy;
+			threshold(grayImage(roi), tmpImage, thresholdValue, 255, THRESH_BINARY);
+			findContours(tmpImage, roiContours, roiHierarchy, RETR_CCOMP, CHAIN_APPROX_SIMPLE, roi.tl());
+			auto toothContour = roiContours.end();
+			double maxArea = 0;
+			for (auto k = 0; k < roiContours.size(); ++k) {
+				if (roiHierarchy[k][3] >= 0)
+					continue;
+				auto const& rect = boundingRect(roiContours[k]);
+				if (rect.x <= roi.x || rect.y <= roi.y || rect.br().x >= roi.br().x || rect.br().y >= roi.br().y)
+					continue;
+				auto const& area = contourArea(roiContours[k]);
+				if (area > maxArea && pointPolygonTest(roiContours[k], seed, false) >= 0) {
+					toothContour = roiContours.begin() + k;
+					maxArea = area;
+				}
+			}
+			if (toothContour < roiContours.end())
+				toothContours.push_back(*toothContour);
+			else {
+				auto contour = contours[j];
+				for (auto point = contour.begin(); point < contour.end(); ++point)
+					*point *= scale;
+				toothContours.push_back(contour);
+			}
+		}
+}
+
+bool analyzeBaseImage(DesignContext& context, Mat const& base, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones], Mat (*const& designImages)[2], Mat* const& baseImage) {
+	Mat thisBaseImage;
+	copyMakeBorder(base, thisBaseImage, baseImageBorder, baseImageBorder, baseImageBorder, baseImageBorder, BORDER_CONSTANT, Scalar::all(255));
+	vector<vector<Point>> contours;
+	vector<Tooth> tmpTeeth;
+	auto const& nTeeth = (nTeethPerZone - 1) * nZones;
+	findToothContours(thisBaseImage, contours, context.segmentationBackend);
+	if (contours.size() != nTeeth)
+		return false;
+	for (auto contour = contours.begin(); contour < contours.end(); ++contour)
+		tmpTeeth.push_back(Tooth(*contour));
 	vector<Point2f> centroids;
 	for (auto tooth = tmpTeeth.begin(); tooth < tmpTeeth.end(); ++tooth)
 		centroids.push_back(tooth->getCentroid());
-	teethEllipse = fitEllipse(centroids);
-	auto const& nTeeth = (nTeethPerZone - 1) * nZones;
+	context.teethEllipse = fitEllipse(centroids);
 	vector<float> angles(nTeeth);
-	auto oldRemedyImage = remedyImage;
-	remedyImage = false;
+	auto oldRemedyImage = context.remedyImage;
+	context.remedyImage = false;
 	for (auto i = 0; i < nTeeth; ++i)
-		computeNormalDirection(centroids[i], &angles[i]);
+		computeNormalDirection(context, centroids[i], &angles[i]);
 	vector<int> idx;
 	sortIdx(angles, idx, SORT_ASCENDING);
 	vector<vector<uint8_t>> isInZone(nZones);
@@ -878,13 +1097,19 @@ void analyzeBaseImage(Mat const& base, vector<Tooth> (&remediedTeeth)[nZones], M
 		auto const& no = idx[i];
 		for (auto j = 0; j < nZones; ++j)
 			if (isInZone[j][no]) {
-				if (j % 2)
-					thisTeeth[j].push_back(tmpTeeth[no]);
-				else
-					thisTeeth[j].insert(thisTeeth[j].begin(), tmpTeeth[no]);
+				thisTeeth[j].push_back(move(tmpTeeth[no]));
 				break;
 			}
 	}
+	for (auto zone = 0; zone < nZones; ++zone)
+		if (thisTeeth[zone].size() != nTeethPerZone - 1) {
+			context.remedyImage = oldRemedyImage;
+			return false;
+		}
+	for (auto zone = 0; zone < nZones; zone += 2)
+		reverse(thisTeeth[zone].begin(), thisTeeth[zone].end());
+	if (baseImage)
+		*baseImage = thisBaseImage;
 	auto const& imageSize = thisBaseImage.size();
 	if (designImages)
 		(*designImages)[0] = Mat(imageSize, CV_8U, 255);
@@ -898,15 +1123,12 @@ void analyzeBaseImage(Mat const& base, vector<Tooth> (&remediedTeeth)[nZones], M
 		}
 		auto const& seventhTooth = thisTeeth[zone][nTeethPerZone - 2];
 		auto& eighthTooth = thisTeeth[zone][nTeethPerZone - 1];
-		auto const& translation = roundToPoint(rotate(computeNormalDirection(seventhTooth.getAnglePoint(180)), CV_PI * (zone % 2 - 0.5)) * seventhTooth.getRadius() * 2.16);
-		auto contour = eighthTooth.getContour();
-		for (auto point = contour.begin(); point < contour.end(); ++point)
-			*point += translation;
-		eighthTooth.setContour(contour);
+		auto const& translation = roundToPoint(rotate(computeNormalDirection(context, seventhTooth.getAnglePoint(180)), CV_PI * (zone % 2 - 0.5)) * seventhTooth.getRadius() * 2.16);
+		eighthTooth.translateContour(translation);
 		centroids.push_back(eighthTooth.getCentroid());
 	}
-	teethEllipse = fitEllipse(centroids);
-	auto theta = degreeToRadian(teethEllipse.angle);
+	context.teethEllipse = fitEllipse(centroids);
+	auto theta = degreeToRadian(context.teethEllipse.angle);
 	auto const& direction = rotate(Point(0, 1), theta);
 	float distance = 0;
 	for (auto zone = 0; zone < nZones; ++zone)
@@ -920,51 +1142,45 @@ void analyzeBaseImage(Mat const& base, vector<Tooth> (&remediedTeeth)[nZones], M
 		remediedTeethZone.clear();
 		for (auto ordinal = 0; ordinal < nTeethPerZone; ++ordinal) {
 			auto& tooth = teethZone[ordinal];
-			tooth.setNormalDirection(computeNormalDirection(tooth.getCentroid()));
-			if (ordinal == nTeethPerZone - 1) {
-				auto contour = tooth.getContour();
-				auto& centroid = tooth.getCentroid();
-				theta = asin(teethZone[ordinal - 1].getNormalDirection().cross(tooth.getNormalDirection()));
-				for (auto point = contour.begin(); point < contour.end(); ++point)
-					*point = centroid + rotate(static_cast<Point2f>(*point) - centroid, theta);
-				tooth.setContour(contour);
-			}
+			tooth.setNormalDirection(computeNormalDirection(context, tooth.getCentroid()));
+			if (ordinal == nTeethPerZone - 1)
+				tooth.rotateContour(tooth.getCentroid(), asin(teethZone[ordinal - 1].getNormalDirection().cross(tooth.getNormalDirection())));
 			auto remediedTooth = tooth;
-			if (zone >= nZones / 2) {
-				auto contour = remediedTooth.getContour();
-				for (auto point = contour.begin(); point < contour.end(); ++point)
-					*point += translation;
-				remediedTooth.setContour(contour);
-			}
+			if (zone >= nZones / 2)
+				remediedTooth.translateContour(translation);
 			centroids.push_back(remediedTooth.getCentroid());
-			remediedTeethZone.push_back(remediedTooth);
+			remediedTeethZone.push_back(move(remediedTooth));
 			tooth.findAnglePoints(zone);
 		}
 	}
 	if (teeth)
-		copy(begin(thisTeeth), end(thisTeeth), *teeth);
-	remediedTeethEllipse = fitEllipse(centroids);
-	theta = degreeToRadian(-remediedTeethEllipse.angle);
-	remediedTeethEllipse.angle = 0;
+		move(begin(thisTeeth), end(thisTeeth), *teeth);
+	context.remediedTeethEllipse = fitEllipse(centroids);
+	theta = degreeToRadian(-context.remediedTeethEllipse.angle);
+	context.remediedTeethEllipse.angle = 0;
 	remediedDesignImages[0] = Mat(imageSize + Size(0, distance * cos(theta)), CV_8U, 255);
-	remedyImage = true;
+	context.remedyImage = true;
 	for (auto zone = 0; zone < nZones; ++zone) {
 		for (auto ordinal = 0; ordinal < nTeethPerZone; ++ordinal) {
 			auto& tooth = remediedTeeth[zone][ordinal];
-			auto contour = tooth.getContour();
 			if (ordinal < nTeethPerZone - 1)
-				polylines(remediedDesignImages[0], contour, true, 0, lineThicknessOfLevel[0], LINE_AA);
-			for (auto point = contour.begin(); point < contour.end(); ++point)
-				*point = remediedTeethEllipse.center + rotate(static_cast<Point2f>(*point) - remediedTeethEllipse.center, theta);
-			tooth.setContour(contour);
-			tooth.setNormalDirection(computeNormalDirection(tooth.getCentroid()));
+				polylines(remediedDesignImages[0], tooth.getContour(), true, 0, lineThicknessOfLevel[0], LINE_AA);
+			tooth.rotateContour(context.remediedTeethEllipse.center, theta);
+			tooth.setNormalDirection(computeNormalDirection(context, tooth.getCentroid()));
 			tooth.findAnglePoints(zone);
 		}
 	}
-	remedyImage = oldRemedyImage;
+	context.remedyImage = oldRemedyImage;
+	return true;
 }
 
-void updateDesign(vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, Mat (&designImages)[2], bool const& justLoadedImage, bool const& justLoadedRpds) {
+void encodeImage(Mat const& image, ImageFormat const& format, int const& level, vector<uchar>& buffer) {
+	ImageEncoder encoder(image.size(), format, level, buffer);
+	encoder.write(image);
+	encoder.finish();
+}
+
+void registerRpds(vector<Tooth> (&teeth)[nZones], vector<Rpd*> const& rpds, bool const& justLoadedImage) {
 	if (!justLoadedImage)
 		for (auto zone = 0; zone < nZones; ++zone)
 			for (auto ordinal = 0; ordinal < nTeethPerZone; ++ordinal)
@@ -983,15 +1199,20 @@ void updateDesign(vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, Mat (&desi
 		if (dentureBase)
 			dentureBase->registerExpectedAnchors(teeth);
 	}
-	if (justLoadedRpds)
-		for (auto rpd = rpds.begin(); rpd < rpds.end(); ++rpd) {
-			auto const& rpdWithLingualArms = dynamic_cast<RpdWithLingualClaspArms*>(*rpd);
-			if (rpdWithLingualArms)
-				rpdWithLingualArms->setLingualClaspArms(teeth);
-			auto const& dentureBase = dynamic_cast<DentureBase*>(*rpd);
-			if (dentureBase)
-				dentureBase->setSide(teeth);
-		}
+}
+
+void setRpds(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds) {
+	for (auto rpd = rpds.begin(); rpd < rpds.end(); ++rpd) {
+		auto const& rpdWithLingualArms = dynamic_cast<RpdWithLingualClaspArms*>(*rpd);
+		if (rpdWithLingualArms)
+			rpdWithLingualArms->setLingualClaspArms(teeth);
+		auto const& dentureBase = dynamic_cast<DentureBase*>(*rpd);
+		if (dentureBase)
+			dentureBase->setSide(context, teeth);
+	}
+}
+
+void registerLingualCoveragesAndDentureBases(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*> const& rpds, TeethTopology& topology) {
 	for (auto rpd = rpds.begin(); rpd < rpds.end(); ++rpd) {
 		auto const& rpdWithLingualCoverage = dynamic_cast<RpdWithLingualCoverage*>(*rpd);
 		if (rpdWithLingualCoverage)
@@ -1000,11 +1221,188 @@ void updateDesign(vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, Mat (&desi
 		if (dentureBase)
 			dentureBase->registerDentureBase(teeth);
 	}
+	topology.registerDentureBases(context, teeth);
+}
+
+void drawRpds(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*> const& rpds, Mat (&designImages)[2]) {
+	context.curveCache->clear();
 	designImages[1] = Mat(designImages[0].size(), CV_8U, 255);
 	for (auto zone = 0; zone < nZones; ++zone) {
-		if (Tooth::isEighthUsed[zone])
+		if (context.isEighthUsed[zone])
 			polylines(designImages[1], teeth[zone][nTeethPerZone - 1].getContour(), true, 0, lineThicknessOfLevel[0], LINE_AA);
 	}
+	if (context.renderInParallel && rpds.size() > 1) {
+		auto const& nWorkers = min<size_t>(max(thread::hardware_concurrency(), 1U), rpds.size());
+		atomic<size_t> nextRpd(0);
+		unique_ptr<vector<Tooth>[][nZones]> workerTeeth(new vector<Tooth>[nWorkers][nZones]);
+		vector<DisplayList> displayLists(rpds.size());
+		vector<future<void>> workers;
+		for (auto i = 0; i < nWorkers; ++i)
+			workers.push_back(async(launch::async, [&, i] {
+				auto& thisTeeth = workerTeeth[i];
+				for (auto zone = 0; zone < nZones; ++zone) {
+					thisTeeth[zone] = teeth[zone];
+					for (auto tooth = thisTeeth[zone].begin(); tooth < thisTeeth[zone].end(); ++tooth)
+						tooth->resetCurveCacheCounts();
+				}
+				CurveCache curveCache;
+				auto thisContext = context;
+				thisContext.curveCache = &curveCache;
+				for (auto rpd = nextRpd++; rpd < rpds.size(); rpd = nextRpd++) {
+					thisContext.displayList = &displayLists[rpd];
+					rpds[rpd]->draw(thisContext, Mat(), thisTeeth);
+				}
+			}));
+		for (auto worker = workers.begin(); worker < workers.end(); ++worker)
+			worker->get();
+		for (auto displayList = displayLists.begin(); displayList < displayLists.end(); ++displayList)
+			displayList->replay(designImages[1]);
+		for (auto i = 0; i < nWorkers; ++i)
+			for (auto zone = 0; zone < nZones; ++zone)
+				for (auto ordinal = 0; ordinal < teeth[zone].size(); ++ordinal)
+					teeth[zone][ordinal].addCurveCacheCounts(workerTeeth[i][zone][ordinal]);
+	}
+	else
+		for (auto rpd = rpds.begin(); rpd < rpds.end(); ++rpd)
+			(*rpd)->draw(context, designImages[1], teeth);
+}
+
+void updateDesign(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, Mat (&designImages)[2], bool const& justLoadedImage, bool const& justLoadedRpds) {
+	registerRpds(teeth, rpds, justLoadedImage);
+	TeethTopology topology(context, teeth);
+	CurveCache curveCache;
+	auto thisContext = context;
+	thisContext.curveCache = &curveCache;
+	thisContext.topology = &topology;
+	if (justLoadedRpds)
+		setRpds(thisContext, teeth, rpds);
+	registerLingualCoveragesAndDentureBases(thisContext, teeth, rpds, topology);
+	drawRpds(thisContext, teeth, rpds, designImages);
+}
+
+void updateDesigns(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Tooth> (&remediedTeeth)[nZones], vector<Rpd*>& rpds, Mat (&designImages)[2], Mat (&remediedDesignImages)[2], bool const& justLoadedImage, bool const& justLoadedRpds) {
+	auto remediedTask = async(launch::async, [&] { registerRpds(remediedTeeth, rpds, justLoadedImage); });
+	registerRpds(teeth, rpds, justLoadedImage);
+	remediedTask.get();
+	TeethTopology topology(context, teeth), remediedTopology(context, remediedTeeth);
+	CurveCache curveCache, remediedCurveCache;
+	auto thisContext = context, remediedContext = context;
+	thisContext.curveCache = &curveCache;
+	thisContext.topology = &topology;
+	remediedContext.curveCache = &remediedCurveCache;
+	remediedContext.topology = &remediedTopology;
+	if (justLoadedRpds)
+		setRpds(remediedContext, remediedTeeth, rpds);
+	remediedTask = async(launch::async, [&] {
+		registerLingualCoveragesAndDentureBases(remediedContext, remediedTeeth, rpds, remediedTopology);
+		drawRpds(remediedContext, remediedTeeth, rpds, remediedDesignImages);
+	});
+	registerLingualCoveragesAndDentureBases(thisContext, teeth, rpds, topology);
+	drawRpds(thisContext, teeth, rpds, designImages);
+	remediedTask.get();
+}
+
+Mat drawDesignTile(DisplayList const& baseDisplayList, DisplayList const& displayList, float const& scale, Size const& canvasSize, Rect const& tileRect) {
+	Mat baseTile(tileRect.size(), CV_8U, 255), tile(tileRect.size(), CV_8U, 255);
+	baseDisplayList.replay(baseTile, scale, -tileRect.tl(), canvasSize);
+	displayList.replay(tile, scale, -tileRect.tl(), canvasSize);
+	bitwise_and(baseTile, tile, tile);
+	return tile;
+}
+
+void drawDesignTiles(DisplayList const& baseDisplayList, DisplayList const& displayList, float const& scale, Size const& canvasSize, int const& tileSide, function<bool(Rect const&, Mat const&)> const& processTile) {
+	vector<Rect> tileRects;
+	if (tileSide > 0)
+		for (auto y = 0; y < canvasSize.height; y += tileSide)
+			for (auto x = 0; x < canvasSize.width; x += tileSide)
+				tileRects.push_back(Rect(x, y, tileSide, tileSide) & Rect(Point(), canvasSize));
+	else
+		tileRects.push_back(Rect(Point(), canvasSize));
+	auto const& nWorkers = min<size_t>(max(thread::hardware_concurrency(), 1U), tileRects.size());
+	auto const& nPendingTiles = nWorkers * 2;
+	atomic<size_t> nextTile(0);
+	size_t nProcessedTiles = 0;
+	vector<Mat> tiles(tileRects.size());
+	mutex tileMutex;
+	condition_variable tileCondition;
+	vector<future<void>> workers;
+	for (auto i = 0; i < nWorkers; ++i)
+		workers.push_back(async(launch::async, [&] {
+			for (auto tile = nextTile++; tile < tileRects.size(); tile = nextTile++) {
+				{
+					unique_lock<mutex> lock(tileMutex);
+					tileCondition.wait(lock, [&] { return tile < nProcessedTiles + nPendingTiles; });
+				}
+				auto const& image = drawDesignTile(baseDisplayList, displayList, scale, canvasSize, tileRects[tile]);
+				lock_guard<mutex> lock(tileMutex);
+				tiles[tile] = image;
+				tileCondition.notify_all();
+			}
+		}));
+	for (auto tile = 0; tile < tileRects.size(); ++tile) {
+		Mat image;
+		{
+			unique_lock<mutex> lock(tileMutex);
+			tileCondition.wait(lock, [&] { return !tiles[tile].empty(); });
+			swap(image, tiles[tile]);
+		}
+		auto const& isContinued = processTile(tileRects[tile], image);
+		lock_guard<mutex> lock(tileMutex);
+		if (isContinued)
+			++nProcessedTiles;
+		else {
+			nextTile = tileRects.size();
+			nProcessedTiles = tileRects.size();
+		}
+		tileCondition.notify_all();
+		if (!isContinued)
+			break;
+	}
+	for (auto worker = workers.begin(); worker < workers.end(); ++worker)
+		worker->get();
+}
+
+void updateDesignTiles(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, float const& scale, Size const& canvasSize, bool const& justLoadedImage, bool const& justLoadedRpds, int const& tileSide, function<bool(Rect const&, Mat const&)> const& processTile) {
+	DisplayList baseDisplayList, displayList;
+	for (auto zone = 0; zone < nZones; ++zone)
+		for (auto ordinal = 0; ordinal < nTeethPerZone - 1; ++ordinal)
+			baseDisplayList.addPolyline(teeth[zone][ordinal].getContour(), true, 0);
+	updateDisplayList(context, teeth, rpds, justLoadedImage, justLoadedRpds, displayList);
+	drawDesignTiles(baseDisplayList, displayList, scale, canvasSize, tileSide, processTile);
+}
+
+void updateDisplayList(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, bool const& justLoadedImage, bool const& justLoadedRpds, DisplayList& displayList) {
+	registerRpds(teeth, rpds, justLoadedImage);
+	TeethTopology topology(context, teeth);
+	CurveCache curveCache;
+	auto thisContext = context;
+	thisContext.curveCache = &curveCache;
+	thisContext.topology = &topology;
+	thisContext.displayList = &displayList;
+	if (justLoadedRpds)
+		setRpds(thisContext, teeth, rpds);
+	registerLingualCoveragesAndDentureBases(thisContext, teeth, rpds, topology);
+	for (auto zone = 0; zone < nZones; ++zone)
+		if (context.isEighthUsed[zone])
+			displayList.addPolyline(teeth[zone][nTeethPerZone - 1].getContour(), true, 0);
 	for (auto rpd = rpds.begin(); rpd < rpds.end(); ++rpd)
-		(*rpd)->draw(designImages[1], teeth);
+		(*rpd)->draw(thisContext, Mat(), teeth);
+}
+
+string getDesignSvg(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, Size const& size, bool const& justLoadedImage, bool const& justLoadedRpds) {
+	DisplayList displayList;
+	for (auto zone = 0; zone < nZones; ++zone)
+		for (auto ordinal = 0; ordinal < nTeethPerZone - 1; ++ordinal)
+			displayList.addPolyline(teeth[zone][ordinal].getContour(), true, 0);
+	updateDisplayList(context, teeth, rpds, justLoadedImage, justLoadedRpds, displayList);
+	return displayList.toSvg(size);
+}
+
+void getCurveCacheCounts(const vector<Tooth> (&teeth)[nZones], size_t& nHits, size_t& nMisses) {
+	nHits = nMisses = 0;
+	for (auto zone = 0; zone < nZones; ++zone)
+		for (auto tooth = teeth[zone].begin(); tooth < teeth[zone].end(); ++tooth) {
+			nHits += tooth->getCurveCacheHits();
+			nMisses += tooth->getCurveCacheMisses();
+		}
 }
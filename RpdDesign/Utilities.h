@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include "Rpd.h"
 
 float degreeToRadian(float const& degree);
@@ -25,44 +27,76 @@ Tooth const& getTooth(const vector<Tooth> (&teeth)[nZones], Rpd::Position const&
 
 Tooth& getTooth(vector<Tooth> (&teeth)[nZones], Rpd::Position const& position);
 
-bool isBlockedByMajorConnector(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions);
+void computeStringCurves(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<float> const& distanceScales, deque<bool> const& keepStartEndPoints, deque<bool> const& considerAnchorDisplacements, bool const& considerDistalPoints, vector<vector<Point>>& curves, float* const& sumOfRadii = nullptr, int* const& nTeeth = nullptr, vector<Point>* const& distalPoints = nullptr);
+
+void computeStringCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, float const& distanceScale, deque<bool> const& keepStartEndPoints, deque<bool> const& considerAnchorDisplacements, bool const& considerDistalPoints, vector<Point>& curve, float* const& sumOfRadii = nullptr, int* const& nTeeth = nullptr, vector<Point>* const& distalPoints = nullptr);
+
+void computeInscribedCurve(DesignContext const& context, vector<Point> const& cornerPoints, vector<Point>& curve, float const& smoothness = 0.5F, bool const& shouldAppend = true);
+
+void computeInscribedCurve(DesignContext const& context, Point const& p0, Point const& p1, Point const& p2, vector<Point>& curve, float const& smoothness = 0.5F);
+
+void computeSmoothCurve(DesignContext const& context, vector<Point> const& curve, vector<Point>& smoothCurve, bool const& isClosed = false, float const& smoothness = 0.5F);
+
+void computePiecewiseSmoothCurve(DesignContext const& context, vector<Point> const& curve, vector<Point>& piecewiseSmoothCurve, bool const& smoothStart = true, bool const& smoothEnd = true);
+
+void fillCurve(Mat const& image, vector<Point> const& curve, Scalar const& color, Point const& offset = Point());
+
+void drawCurve(DesignContext const& context, Mat const& designImage, vector<Point> const& curve, bool const& isClosed, int const& level);
+
+void drawEllipse(DesignContext const& context, Mat const& designImage, Point2f const& center, Size2f const& axes, float const& angle, float const& startAngle, float const& endAngle, int const& level);
 
-void computeStringCurves(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<float> const& distanceScales, deque<bool> const& keepStartEndPoints, deque<bool> const& considerAnchorDisplacements, bool const& considerDistalPoints, vector<vector<Point>>& curves, float* const& sumOfRadii = nullptr, int* const& nTeeth = nullptr, vector<Point>* const& distalPoints = nullptr);
+void drawFill(DesignContext const& context, Mat const& designImage, vector<Point> const& curve, uchar const& color);
 
-void computeStringCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, float const& distanceScale, deque<bool> const& keepStartEndPoints, deque<bool> const& considerAnchorDisplacements, bool const& considerDistalPoints, vector<Point>& curve, float* const& sumOfRadii = nullptr, int* const& nTeeth = nullptr, vector<Point>* const& distalPoints = nullptr);
+void drawLayer(DesignContext const& context, Mat const& designImage, vector<Point> const& curve, uchar const& color, const vector<Point>* const& hole = nullptr);
 
-void computeInscribedCurve(vector<Point> const& cornerPoints, vector<Point>& curve, float const& smoothness = 0.5F, bool const& shouldAppend = true);
+void drawLine(DesignContext const& context, Mat const& designImage, Point2f const& p1, Point2f const& p2, int const& level);
 
-void computeSmoothCurve(vector<Point> const& curve, vector<Point>& smoothCurve, bool const& isClosed = false, float const& smoothness = 0.5F);
+Rect getLayerRect(DesignContext const& context, Mat const& designImage, vector<Point> const& curve);
 
-void computePiecewiseSmoothCurve(vector<Point> const& curve, vector<Point>& piecewiseSmoothCurve, bool const& smoothStart = true, bool const& smoothEnd = true);
+Mat getLayer(Size const& size);
 
-void computeLingualCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<vector<Point>>& curves, vector<Point>* const& distalPoints = nullptr, const vector<Point>* const& anchorPoints = nullptr);
+void computeLingualCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<vector<Point>>& curves, vector<Point>* const& distalPoints = nullptr, const vector<Point>* const& anchorPoints = nullptr);
 
-void computeLingualCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<vector<Point>>& curves, Point& distalPoint, const vector<Point>* const& anchorPoints = nullptr);
+void computeLingualCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<vector<Point>>& curves, Point& distalPoint, const vector<Point>* const& anchorPoints = nullptr);
 
-void computeMesialCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<Point>* const& innerCurve = nullptr);
+void computeMesialCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, vector<Point>* const& innerCurve = nullptr);
 
-void computeDistalCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point> const& distalPoints, vector<Point>& curve, vector<Point>* const& innerCurve = nullptr);
+void computeDistalCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point> const& distalPoints, vector<Point>& curve, vector<Point>* const& innerCurve = nullptr);
 
-void computeInnerCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, float const& avgRadius, vector<Point>& curve, vector<vector<Point>>& curves, const vector<Point>* const& anchorPoints = nullptr);
+void computeInnerCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, float const& avgRadius, vector<Point>& curve, vector<vector<Point>>& curves, const vector<Point>* const& anchorPoints = nullptr);
 
-void computeOuterCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, float* const& avgRadius = nullptr);
+void computeOuterCurve(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve, float* const& avgRadius = nullptr);
 
 void computeLingualConfrontationCurve(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Point>& curve);
 
 void computeLingualConfrontationCurves(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<vector<Point>>& curves);
 
-Point2f computeNormalDirection(Point2f const& point, float* const& angle = nullptr);
+Point2f computeNormalDirection(DesignContext const& context, Point2f const& point, float* const& angle = nullptr);
+
+void computeNormalDirections(DesignContext const& context, vector<Point> const& points, vector<Point2f>& normalDirections);
+
+bool shouldAnchor(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], Rpd::Position const& position, Rpd::Direction const& direction);
+
+void findAnchorPoints(DesignContext const& context, const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Rpd::Position>& startEndPositions, const vector<Point>* const& inAnchorPoints = nullptr, vector<Point>* const& outAnchorPoints = nullptr);
+
+bool isLastTooth(DesignContext const& context, Rpd::Position const& position);
+
+bool queryRpds(DesignContext& context, JNIEnv* const& env, jobject const& ontModel, vector<Rpd*>& rpds);
+
+void findToothContours(Mat const& image, vector<vector<Point>>& toothContours, SegmentationBackend const& backend = CONTOUR_TREE);
+
+bool analyzeBaseImage(DesignContext& context, Mat const& image, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones] = nullptr, Mat (*const& designImages)[2] = nullptr, Mat* const& baseImage = nullptr);
+
+void encodeImage(Mat const& image, ImageFormat const& format, int const& level, vector<uchar>& buffer);
 
-bool shouldAnchor(const vector<Tooth> (&teeth)[nZones], Rpd::Position const& position, Rpd::Direction const& direction);
+void updateDesign(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, Mat (&designImages)[2], bool const& justLoadedImage, bool const& justLoadedRpds);
 
-void findAnchorPoints(const vector<Tooth> (&teeth)[nZones], vector<Rpd::Position> const& positions, vector<Rpd::Position>& startEndPositions, const vector<Point>* const& inAnchorPoints = nullptr, vector<Point>* const& outAnchorPoints = nullptr);
+void updateDesigns(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Tooth> (&remediedTeeth)[nZones], vector<Rpd*>& rpds, Mat (&designImages)[2], Mat (&remediedDesignImages)[2], bool const& justLoadedImage, bool const& justLoadedRpds);
 
-bool isLastTooth(Rpd::Position const& position);
+void updateDesignTiles(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, float const& scale, Size const& canvasSize, bool const& justLoadedImage, bool const& justLoadedRpds, int const& tileSide, function<bool(Rect const&, Mat const&)> const& processTile);
 
-bool queryRpds(JNIEnv* const& env, jobject const& ontModel, vector<Rpd*>& rpds);
+void updateDisplayList(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, bool const& justLoadedImage, bool const& justLoadedRpds, DisplayList& displayList);
 
-void analyzeBaseImage(Mat const& image, vector<Tooth> (&remediedTeeth)[nZones], Mat (&remediedDesignImages)[2], vector<Tooth> (*const& teeth)[nZones] = nullptr, Mat (*const& designImages)[2] = nullptr, Mat* const& baseImage = nullptr);
+string getDesignSvg(DesignContext const& context, vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, Size const& size, bool const& justLoadedImage, bool const& justLoadedRpds);
 
-void updateDesign(vector<Tooth> (&teeth)[nZones], vector<Rpd*>& rpds, Mat (&designImages)[2], bool const& justLoadedImage, bool const& justLoadedRpds);
+void getCurveCacheCounts(const vector<Tooth> (&teeth)[nZones], size_t& nHits, size_t& nMisses);
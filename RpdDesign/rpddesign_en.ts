@@ -70,6 +70,11 @@
         <source>Not a Valid Image!</source>
         <translation>Not a Valid Image!</translation>
     </message>
+    <message>
+        <location filename="RpdDesign.cpp" line="86"/>
+        <source>Not a Valid Base Image!</source>
+        <translation>Not a Valid Base Image!</translation>
+    </message>
     <message>
         <location filename="RpdDesign.cpp" line="109"/>
         <source>Select RPD Information</source>
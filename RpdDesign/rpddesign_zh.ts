@@ -70,6 +70,11 @@
         <source>Not a Valid Image!</source>
         <translation>非有效的图像文件！</translation>
     </message>
+    <message>
+        <location filename="RpdDesign.cpp" line="86"/>
+        <source>Not a Valid Base Image!</source>
+        <translation>非有效的底图文件！</translation>
+    </message>
     <message>
         <location filename="RpdDesign.cpp" line="109"/>
         <source>Select RPD Information</source>
@@ -0,0 +1,182 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../RpdDesign/AnalysisCache.h"
+#include "../RpdDesign/Utilities.h"
+
+char const* const segmentationBackendNames[]{"CONTOUR_TREE", "CONNECTED_COMPONENTS"};
+
+float const minContourOverlap = 0.95F;
+
+int const nBenchmarkRuns = 20, nSegmentationBackends = 2, nTeeth = (nTeethPerZone - 1) * nZones;
+
+atomic<size_t> nAllocations(0);
+
+void* operator new(size_t size) {
+	++nAllocations;
+	if (auto const& pointer = malloc(size ? size : 1))
+		return pointer;
+	throw bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { free(pointer); }
+
+Point2f computeCentroid(vector<Point> const& contour) {
+	auto const& moment = moments(contour);
+	return moment.m00 ? Point2f(moment.m10 / moment.m00, moment.m01 / moment.m00) : static_cast<Point2f>(contour[0]);
+}
+
+float computeOverlap(vector<Point> const& contour1, vector<Point> const& contour2) {
+	auto const& rect = boundingRect(contour1) | boundingRect(contour2);
+	Mat mask1(rect.size(), CV_8U, Scalar::all(0)), mask2(rect.size(), CV_8U, Scalar::all(0));
+	fillPoly(mask1, vector<vector<Point>>{contour1}, 255, LINE_8, 0, -rect.tl());
+	fillPoly(mask2, vector<vector<Point>>{contour2}, 255, LINE_8, 0, -rect.tl());
+	Mat intersectionMask, unionMask;
+	bitwise_and(mask1, mask2, intersectionMask);
+	bitwise_or(mask1, mask2, unionMask);
+	auto const& nUnion = countNonZero(unionMask);
+	return nUnion ? static_cast<float>(countNonZero(intersectionMask)) / nUnion : 1;
+}
+
+bool matchContours(vector<vector<Point>> contours, vector<vector<Point>> const& referenceContours, int const& scale, string const& description) {
+	if (contours.size() != referenceContours.size()) {
+		cerr << description << ": " << contours.size() << " contours, " << referenceContours.size() << " expected" << endl;
+		return false;
+	}
+	for (auto contour = contours.begin(); contour < contours.end(); ++contour) {
+		for (auto point = contour->begin(); point < contour->end(); ++point)
+			*point *= scale;
+		auto const& centroid = computeCentroid(*contour);
+		auto const& referenceContour = min_element(referenceContours.begin(), referenceContours.end(), [&centroid](vector<Point> const& contour1, vector<Point> const& contour2) { return norm(computeCentroid(contour1) - centroid) < norm(computeCentroid(contour2) - centroid); });
+		auto const& overlap = computeOverlap(*contour, *referenceContour);
+		if (overlap < minContourOverlap) {
+			cerr << description << ": contour near (" << centroid.x << ", " << centroid.y << ") overlaps the expected one by " << overlap << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool verifySegmentation(Mat const& base) {
+	Mat image, upscaledImage;
+	copyMakeBorder(base, image, baseImageBorder, baseImageBorder, baseImageBorder, baseImageBorder, BORDER_CONSTANT, Scalar::all(255));
+	auto const& upscale = maxSegmentationSide * 2 / max(image.cols, image.rows) + 1;
+	resize(image, upscaledImage, Size(), upscale, upscale, INTER_LINEAR);
+	vector<vector<Point>> referenceContours;
+	findToothContours(image, referenceContours);
+	if (referenceContours.size() != nTeeth) {
+		cerr << segmentationBackendNames[CONTOUR_TREE] << ": " << referenceContours.size() << " contours, " << nTeeth << " expected" << endl;
+		return false;
+	}
+	for (auto backend = 0; backend < nSegmentationBackends; ++backend) {
+		vector<vector<Point>> contours, upscaledContours;
+		findToothContours(image, contours, static_cast<SegmentationBackend>(backend));
+		findToothContours(upscaledImage, upscaledContours, static_cast<SegmentationBackend>(backend));
+		if (!matchContours(contours, referenceContours, 1, segmentationBackendNames[backend]) || !matchContours(contours, upscaledContours, upscale, segmentationBackendNames[backend] + string(" on the upscaled image")))
+			return false;
+	}
+	return true;
+}
+
+void benchmark(string const& name, function<void()> const& run) {
+	run();
+	auto const& nAllocationsBefore = nAllocations.load();
+	auto const& start = chrono::steady_clock::now();
+	for (auto i = 0; i < nBenchmarkRuns; ++i)
+		run();
+	auto const& time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / nBenchmarkRuns;
+	cout << name << ": " << time << " ms, " << static_cast<double>(nAllocations - nAllocationsBefore) / nBenchmarkRuns << " allocations" << endl;
+}
+
+void benchmarkSegmentation(Mat const& base) {
+	Mat image;
+	copyMakeBorder(base, image, baseImageBorder, baseImageBorder, baseImageBorder, baseImageBorder, BORDER_CONSTANT, Scalar::all(255));
+	for (auto backend = 0; backend < nSegmentationBackends; ++backend) {
+		vector<vector<Point>> contours;
+		findToothContours(image, contours, static_cast<SegmentationBackend>(backend));
+		benchmark(segmentationBackendNames[backend] + string(" (") + to_string(contours.size()) + " teeth)", [&] { findToothContours(image, contours, static_cast<SegmentationBackend>(backend)); });
+	}
+}
+
+bool benchmarkTeeth(Mat const& base) {
+	DesignContext context;
+	vector<Tooth> remediedTeeth[nZones], teeth[nZones];
+	Mat remediedDesignImages[2], designImages[2];
+	if (!analyzeBaseImage(context, base, remediedTeeth, remediedDesignImages, &teeth, &designImages)) {
+		cerr << "Not a base image of " << nTeeth << " teeth" << endl;
+		return false;
+	}
+	benchmark("findAnglePoints (360 angles)", [&] {
+		for (auto zone = 0; zone < nZones; ++zone)
+			for (auto tooth = teeth[zone].begin(); tooth < teeth[zone].end(); ++tooth) {
+				tooth->findAnglePoints(zone);
+				for (auto angle = 0; angle < 360; ++angle)
+					tooth->getAnglePoint(angle);
+			}
+	});
+	vector<vector<Point>> polygons;
+	for (auto zone = 0; zone < nZones; ++zone)
+		for (auto tooth = teeth[zone].begin(); tooth < teeth[zone].end(); ++tooth) {
+			vector<Point> polygon;
+			for (auto angle = 0; angle < 360; angle += 30)
+				polygon.push_back(tooth->getAnglePoint(angle));
+			polygons.push_back(polygon);
+		}
+	vector<Point> curve;
+	benchmark("computeSmoothCurve", [&] {
+		for (auto polygon = polygons.begin(); polygon < polygons.end(); ++polygon)
+			computeSmoothCurve(context, *polygon, curve, true);
+	});
+	benchmark("computePiecewiseSmoothCurve", [&] {
+		for (auto polygon = polygons.begin(); polygon < polygons.end(); ++polygon)
+			computePiecewiseSmoothCurve(context, *polygon, curve);
+	});
+	benchmark("computeInscribedCurve", [&] {
+		for (auto polygon = polygons.begin(); polygon < polygons.end(); ++polygon)
+			computeInscribedCurve(context, *polygon, curve, 0.5F, false);
+	});
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		cerr << "Usage: RpdDesignBake <base image> <output file>" << endl << "       RpdDesignBake --verify <base image>" << endl << "       RpdDesignBake --bench <base image>" << endl;
+		return 1;
+	}
+	if (string(argv[1]) == "--verify" || string(argv[1]) == "--bench") {
+		auto const& base = imread(argv[2], IMREAD_COLOR);
+		if (base.empty()) {
+			cerr << "Not a valid image: " << argv[2] << endl;
+			return 1;
+		}
+		if (string(argv[1]) == "--verify")
+			return verifySegmentation(base) ? 0 : 1;
+		benchmarkSegmentation(base);
+		return benchmarkTeeth(base) ? 0 : 1;
+	}
+	ifstream sourceFile(argv[1], ios::binary);
+	vector<uchar> source((istreambuf_iterator<char>(sourceFile)), istreambuf_iterator<char>());
+	auto const& base = imdecode(source, IMREAD_COLOR);
+	if (base.empty()) {
+		cerr << "Not a valid image: " << argv[1] << endl;
+		return 1;
+	}
+	vector<uchar> buffer;
+	if (!AnalysisCache().bake(base, AnalysisCache::hashBytes(source.data(), source.size()), buffer)) {
+		cerr << "Not a base image of " << nTeeth << " teeth: " << argv[1] << endl;
+		return 1;
+	}
+	ofstream file(argv[2], ios::binary | ios::trunc);
+	if (!file.write(reinterpret_cast<char const*>(buffer.data()), buffer.size())) {
+		cerr << "Cannot write: " << argv[2] << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -1,11 +1,54 @@
+#include <atomic>
 #include <opencv2/highgui/highgui.hpp>
 
 #include "com_shengjie_Main.h"
 #include "dllmain.h"
+#include "../RpdDesign/AnalysisCache.h"
+#include "../RpdDesign/ImageEncoder.h"
 #include "../RpdDesign/resource.h"
-#include "../RpdDesign/Tooth.h"
 #include "../RpdDesign/Utilities.h"
 
+AnalysisCache analysisCache;
+
+atomic<float> arcTolerance(0.25F);
+
+atomic<bool> renderInParallel(false);
+
+atomic<SegmentationBackend> segmentationBackend(CONTOUR_TREE);
+
+thread_local size_t curveCacheCounts[2];
+
+thread_local jweak pendingOntModel;
+
+thread_local uint64_t pendingImageKey;
+
+thread_local vector<uchar> pendingImage;
+
+const jsize streamChunkSize = 1 << 16;
+
+void throwIllegalArgumentException(JNIEnv* const& env, string const& message) { env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), message.c_str()); }
+
+bool checkImageFormat(JNIEnv* const& env, jint const& format) {
+	if (format >= PNG && format <= QOI)
+		return true;
+	throwIllegalArgumentException(env, "Unknown image format: " + to_string(format));
+	return false;
+}
+
+vector<uchar> getBytes(JNIEnv* const& env, jbyteArray const& array) {
+	vector<uchar> bytes(env->GetArrayLength(array));
+	env->GetByteArrayRegion(array, 0, bytes.size(), reinterpret_cast<jbyte*>(bytes.data()));
+	return bytes;
+}
+
+bool decodeBaseImage(JNIEnv* const& env, vector<uchar> const& bytes, Mat& baseImage) {
+	baseImage = imdecode(bytes, IMREAD_COLOR);
+	if (!baseImage.empty())
+		return true;
+	throwIllegalArgumentException(env, "Not a valid image");
+	return false;
+}
+
 jobject matToJMat(JNIEnv* const& env, Mat const& mat) {
 	auto const& clsStrMat = "org/opencv/core/Mat";
 	auto const& clsMat = env->FindClass(clsStrMat);
@@ -25,21 +68,217 @@ Mat& jMatToMat(JNIEnv* const& env, jobject const& jMat) {
 	return *reinterpret_cast<Mat*>(matAddr);
 }
 
+bool analyzeBaseImage(JNIEnv* const& env, DesignContext& context, Mat const& base, vector<Tooth> (&teeth)[nZones], Mat (&designImages)[2]) {
+	if (analysisCache.analyzeBaseImage(context, base, teeth, designImages))
+		return true;
+	throwIllegalArgumentException(env, "Not a base image of " + to_string((nTeethPerZone - 1) * nZones) + " teeth");
+	return false;
+}
+
+bool analyzeDefaultBaseImage(JNIEnv* const& env, DesignContext& context, vector<Tooth> (&teeth)[nZones], Mat (&designImages)[2]) {
+	auto const& hRsrc = FindResource(dllHandle, MAKEINTRESOURCE(IDB_PNG1), TEXT("PNG"));
+	auto const& pBuf = static_cast<uchar*>(LockResource(LoadResource(dllHandle, hRsrc)));
+	auto const& bufSize = SizeofResource(dllHandle, hRsrc);
+	auto const& hBakedRsrc = FindResource(dllHandle, MAKEINTRESOURCE(IDR_RCDATA1), RT_RCDATA);
+	auto const& pBakedBuf = static_cast<uchar*>(LockResource(LoadResource(dllHandle, hBakedRsrc)));
+	return analysisCache.analyzeBakedImage(context, pBakedBuf, SizeofResource(dllHandle, hBakedRsrc), AnalysisCache::hashBytes(pBuf, bufSize), teeth, designImages) || analyzeBaseImage(env, context, imdecode(vector<uchar>(pBuf, pBuf + bufSize), IMREAD_COLOR), teeth, designImages);
+}
+
+Mat computeRpdDesign(JNIEnv* const& env, jobject const& ontModel, DesignContext& context, vector<Tooth> (&teeth)[nZones], Mat (&designImages)[2]) {
+	vector<Rpd*> rpds;
+	queryRpds(context, env, ontModel, rpds);
+	updateDesign(context, teeth, rpds, designImages, true, true);
+	getCurveCacheCounts(teeth, curveCacheCounts[0], curveCacheCounts[1]);
+	for (auto rpd = rpds.begin(); rpd < rpds.end(); ++rpd)
+		delete *rpd;
+	bitwise_and(designImages[0], designImages[1], designImages[0]);
+	return designImages[0];
+}
+
+Mat computeRpdDesign(JNIEnv* const& env, jobject const& ontModel, const Mat* const& base) {
+	DesignContext context;
+	vector<Tooth> teeth[nZones];
+	Mat designImages[2];
+	context.renderInParallel = renderInParallel;
+	context.arcTolerance = arcTolerance;
+	context.segmentationBackend = segmentationBackend;
+	if (base ? !analyzeBaseImage(env, context, *base, teeth, designImages) : !analyzeDefaultBaseImage(env, context, teeth, designImages))
+		return Mat();
+	return computeRpdDesign(env, ontModel, context, teeth, designImages);
+}
+
+jbyteArray encodeRpdDesign(JNIEnv* const& env, Mat const& design, jint const& format, jint const& level) {
+	if (design.empty())
+		return nullptr;
+	vector<uchar> buffer;
+	encodeImage(design, static_cast<ImageFormat>(format), level, buffer);
+	auto const& bytes = env->NewByteArray(buffer.size());
+	env->SetByteArrayRegion(bytes, 0, buffer.size(), reinterpret_cast<const jbyte*>(buffer.data()));
+	return bytes;
+}
+
+jint writeRpdDesignImage(JNIEnv* const& env, jobject const& ontModel, const vector<uchar>* const& base, jobject const& buffer, jint const& format, jint const& level) {
+	if (!checkImageFormat(env, format))
+		return 0;
+	auto const& address = static_cast<uchar*>(env->GetDirectBufferAddress(buffer));
+	if (!address) {
+		throwIllegalArgumentException(env, "Not a direct buffer");
+		return 0;
+	}
+	float const settings[]{static_cast<float>(format), static_cast<float>(level), arcTolerance, static_cast<float>(renderInParallel), static_cast<float>(segmentationBackend)};
+	auto const& key = AnalysisCache::hashBytes(reinterpret_cast<uchar const*>(settings), sizeof settings, base ? AnalysisCache::hashBytes(base->data(), base->size()) : 0);
+	if (!pendingOntModel || !env->IsSameObject(pendingOntModel, ontModel) || pendingImageKey != key) {
+		Mat baseImage;
+		if (base && !decodeBaseImage(env, *base, baseImage))
+			return 0;
+		auto const& design = computeRpdDesign(env, ontModel, base ? &baseImage : nullptr);
+		if (design.empty())
+			return 0;
+		encodeImage(design, static_cast<ImageFormat>(format), level, pendingImage);
+		if (pendingOntModel)
+			env->DeleteWeakGlobalRef(pendingOntModel);
+		pendingOntModel = env->NewWeakGlobalRef(ontModel);
+		pendingImageKey = key;
+	}
+	auto const& size = static_cast<jint>(pendingImage.size());
+	if (env->GetDirectBufferCapacity(buffer) < size)
+		return -size;
+	copy(pendingImage.begin(), pendingImage.end(), address);
+	env->DeleteWeakGlobalRef(pendingOntModel);
+	pendingOntModel = nullptr;
+	return size;
+}
+
+bool writeToStream(JNIEnv* const& env, jobject const& stream, jmethodID const& write, jbyteArray const& chunk, vector<uchar>& buffer) {
+	for (size_t offset = 0; offset < buffer.size(); offset += streamChunkSize) {
+		auto const& length = static_cast<jsize>(min<size_t>(buffer.size() - offset, streamChunkSize));
+		env->SetByteArrayRegion(chunk, 0, length, reinterpret_cast<const jbyte*>(buffer.data() + offset));
+		env->CallVoidMethod(stream, write, chunk, 0, length);
+		if (env->ExceptionCheck())
+			return false;
+	}
+	buffer.clear();
+	return true;
+}
+
+jstring getRpdDesignSvg(JNIEnv* const& env, jobject const& ontModel, DesignContext& context, vector<Tooth> (&teeth)[nZones], Mat (&designImages)[2]) {
+	vector<Rpd*> rpds;
+	queryRpds(context, env, ontModel, rpds);
+	auto const& svg = getDesignSvg(context, teeth, rpds, designImages[0].size(), true, true);
+	getCurveCacheCounts(teeth, curveCacheCounts[0], curveCacheCounts[1]);
+	for (auto rpd = rpds.begin(); rpd < rpds.end(); ++rpd)
+		delete *rpd;
+	return env->NewStringUTF(svg.c_str());
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_shengjie_Main_getCurveCacheStatistics(JNIEnv* env, jclass) {
+	jlong const counts[]{static_cast<jlong>(curveCacheCounts[0]), static_cast<jlong>(curveCacheCounts[1])};
+	auto const& statistics = env->NewLongArray(2);
+	env->SetLongArrayRegion(statistics, 0, 2, counts);
+	return statistics;
+}
+
 JNIEXPORT jobject JNICALL Java_com_shengjie_Main_getRpdDesign__Lorg_apache_jena_ontology_OntModel_2Lorg_opencv_core_Mat_2(JNIEnv* env, jclass, jobject ontModel, jobject base) {
+	auto const& design = computeRpdDesign(env, ontModel, &jMatToMat(env, base));
+	return design.empty() ? nullptr : matToJMat(env, design);
+}
+
+JNIEXPORT jobject JNICALL Java_com_shengjie_Main_getRpdDesign__Lorg_apache_jena_ontology_OntModel_2(JNIEnv* env, jclass, jobject ontModel) {
+	auto const& design = computeRpdDesign(env, ontModel, nullptr);
+	return design.empty() ? nullptr : matToJMat(env, design);
+}
+
+JNIEXPORT jstring JNICALL Java_com_shengjie_Main_getRpdDesignSvg__Lorg_apache_jena_ontology_OntModel_2Lorg_opencv_core_Mat_2(JNIEnv* env, jclass, jobject ontModel, jobject base) {
+	DesignContext context;
+	vector<Tooth> teeth[nZones];
+	Mat designImages[2];
+	context.arcTolerance = arcTolerance;
+	context.segmentationBackend = segmentationBackend;
+	return analyzeBaseImage(env, context, jMatToMat(env, base), teeth, designImages) ? getRpdDesignSvg(env, ontModel, context, teeth, designImages) : nullptr;
+}
+
+JNIEXPORT jstring JNICALL Java_com_shengjie_Main_getRpdDesignSvg__Lorg_apache_jena_ontology_OntModel_2(JNIEnv* env, jclass, jobject ontModel) {
+	DesignContext context;
 	vector<Tooth> teeth[nZones];
 	Mat designImages[2];
-	analyzeBaseImage(jMatToMat(env, base), teeth, designImages);
+	context.arcTolerance = arcTolerance;
+	context.segmentationBackend = segmentationBackend;
+	return analyzeDefaultBaseImage(env, context, teeth, designImages) ? getRpdDesignSvg(env, ontModel, context, teeth, designImages) : nullptr;
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_shengjie_Main_getRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2_3BII(JNIEnv* env, jclass, jobject ontModel, jbyteArray base, jint format, jint level) {
+	Mat baseImage;
+	if (!checkImageFormat(env, format) || !decodeBaseImage(env, getBytes(env, base), baseImage))
+		return nullptr;
+	return encodeRpdDesign(env, computeRpdDesign(env, ontModel, &baseImage), format, level);
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_shengjie_Main_getRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2II(JNIEnv* env, jclass, jobject ontModel, jint format, jint level) { return checkImageFormat(env, format) ? encodeRpdDesign(env, computeRpdDesign(env, ontModel, nullptr), format, level) : nullptr; }
+
+JNIEXPORT jint JNICALL Java_com_shengjie_Main_writeRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2_3BLjava_nio_ByteBuffer_2II(JNIEnv* env, jclass, jobject ontModel, jbyteArray base, jobject buffer, jint format, jint level) {
+	auto const& bytes = getBytes(env, base);
+	return writeRpdDesignImage(env, ontModel, &bytes, buffer, format, level);
+}
+
+JNIEXPORT jint JNICALL Java_com_shengjie_Main_writeRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2Ljava_nio_ByteBuffer_2II(JNIEnv* env, jclass, jobject ontModel, jobject buffer, jint format, jint level) { return writeRpdDesignImage(env, ontModel, nullptr, buffer, format, level); }
+
+JNIEXPORT void JNICALL Java_com_shengjie_Main_writeRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2Ljava_io_OutputStream_2FIII(JNIEnv* env, jclass, jobject ontModel, jobject stream, jfloat scale, jint tileSide, jint format, jint level) {
+	if (!checkImageFormat(env, format))
+		return;
+	if (scale <= 0) {
+		throwIllegalArgumentException(env, "Non-positive scale: " + to_string(scale));
+		return;
+	}
+	if (format == PNG && tileSide > 0) {
+		throwIllegalArgumentException(env, "PNG cannot be written in tiles");
+		return;
+	}
+	DesignContext context;
+	vector<Tooth> teeth[nZones];
+	Mat designImages[2];
+	context.arcTolerance = arcTolerance;
+	context.segmentationBackend = segmentationBackend;
+	if (!analyzeDefaultBaseImage(env, context, teeth, designImages))
+		return;
 	vector<Rpd*> rpds;
-	queryRpds(env, ontModel, rpds);
-	updateDesign(teeth, rpds, designImages, true, true);
+	queryRpds(context, env, ontModel, rpds);
+	Size const canvasSize(cvRound(designImages[0].cols * scale), cvRound(designImages[0].rows * scale));
+	auto const& write = env->GetMethodID(env->GetObjectClass(stream), "write", "([BII)V");
+	auto const& chunk = env->NewByteArray(streamChunkSize);
+	vector<uchar> buffer;
+	ImageEncoder encoder(canvasSize, static_cast<ImageFormat>(format), level, buffer);
+	Mat band;
+	updateDesignTiles(context, teeth, rpds, scale, canvasSize, true, true, tileSide, [&](Rect const& tileRect, Mat const& tile) {
+		if (!tileRect.x)
+			band.create(tileRect.height, canvasSize.width, CV_8U);
+		tile.copyTo(band(Rect(tileRect.x, 0, tileRect.width, tileRect.height)));
+		if (tileRect.br().x < canvasSize.width)
+			return true;
+		encoder.write(band);
+		return writeToStream(env, stream, write, chunk, buffer);
+	});
+	if (!env->ExceptionCheck()) {
+		encoder.finish();
+		writeToStream(env, stream, write, chunk, buffer);
+	}
+	getCurveCacheCounts(teeth, curveCacheCounts[0], curveCacheCounts[1]);
 	for (auto rpd = rpds.begin(); rpd < rpds.end(); ++rpd)
 		delete *rpd;
-	bitwise_and(designImages[0], designImages[1], designImages[0]);
-	return matToJMat(env, designImages[0]);
 }
 
-JNIEXPORT jobject JNICALL Java_com_shengjie_Main_getRpdDesign__Lorg_apache_jena_ontology_OntModel_2(JNIEnv* env, jclass cls, jobject ontModel) {
-	auto const& hRsrc = FindResource(dllHandle, MAKEINTRESOURCE(IDB_PNG1), TEXT("PNG"));
-	auto const& pBuf = static_cast<uchar*>(LockResource(LoadResource(dllHandle, hRsrc)));
-	return Java_com_shengjie_Main_getRpdDesign__Lorg_apache_jena_ontology_OntModel_2Lorg_opencv_core_Mat_2(env, cls, ontModel, matToJMat(env, imdecode(vector<uchar>(pBuf, pBuf + SizeofResource(dllHandle, hRsrc)), IMREAD_COLOR)));
+JNIEXPORT void JNICALL Java_com_shengjie_Main_setAnalysisCacheDirectory(JNIEnv* env, jclass, jstring directory) {
+	auto const& chars = env->GetStringUTFChars(directory, nullptr);
+	analysisCache.setDirectory(chars);
+	env->ReleaseStringUTFChars(directory, chars);
+}
+
+JNIEXPORT void JNICALL Java_com_shengjie_Main_setArcTolerance(JNIEnv*, jclass, jfloat tolerance) { arcTolerance = tolerance; }
+
+JNIEXPORT void JNICALL Java_com_shengjie_Main_setParallelRendering(JNIEnv*, jclass, jboolean isParallel) { renderInParallel = isParallel == JNI_TRUE; }
+
+JNIEXPORT void JNICALL Java_com_shengjie_Main_setSegmentationBackend(JNIEnv* env, jclass, jint backend) {
+	if (backend >= CONTOUR_TREE && backend <= CONNECTED_COMPONENTS)
+		segmentationBackend = static_cast<SegmentationBackend>(backend);
+	else
+		throwIllegalArgumentException(env, "Unknown segmentation backend: " + to_string(backend));
 }
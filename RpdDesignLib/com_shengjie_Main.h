@@ -6,6 +6,13 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    getCurveCacheStatistics
+	 * Signature: ()[J
+	 */
+	JNIEXPORT jlongArray JNICALL Java_com_shengjie_Main_getCurveCacheStatistics(JNIEnv* env, jclass);
+
 	/*
 	 * Class:     com_shengjie_Main
 	 * Method:    getRpdDesign
@@ -18,7 +25,84 @@ extern "C" {
 	 * Method:    getRpdDesign
 	 * Signature: (Lorg/apache/jena/ontology/OntModel;)Lorg/opencv/core/Mat;
 	 */
-	JNIEXPORT jobject JNICALL Java_com_shengjie_Main_getRpdDesign__Lorg_apache_jena_ontology_OntModel_2(JNIEnv* env, jclass cls, jobject ontModel);
+	JNIEXPORT jobject JNICALL Java_com_shengjie_Main_getRpdDesign__Lorg_apache_jena_ontology_OntModel_2(JNIEnv* env, jclass, jobject ontModel);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    getRpdDesignImage
+	 * Signature: (Lorg/apache/jena/ontology/OntModel;[BII)[B
+	 */
+	JNIEXPORT jbyteArray JNICALL Java_com_shengjie_Main_getRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2_3BII(JNIEnv* env, jclass, jobject ontModel, jbyteArray base, jint format, jint level);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    getRpdDesignImage
+	 * Signature: (Lorg/apache/jena/ontology/OntModel;II)[B
+	 */
+	JNIEXPORT jbyteArray JNICALL Java_com_shengjie_Main_getRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2II(JNIEnv* env, jclass, jobject ontModel, jint format, jint level);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    getRpdDesignSvg
+	 * Signature: (Lorg/apache/jena/ontology/OntModel;Lorg/opencv/core/Mat;)Ljava/lang/String;
+	 */
+	JNIEXPORT jstring JNICALL Java_com_shengjie_Main_getRpdDesignSvg__Lorg_apache_jena_ontology_OntModel_2Lorg_opencv_core_Mat_2(JNIEnv* env, jclass, jobject ontModel, jobject base);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    getRpdDesignSvg
+	 * Signature: (Lorg/apache/jena/ontology/OntModel;)Ljava/lang/String;
+	 */
+	JNIEXPORT jstring JNICALL Java_com_shengjie_Main_getRpdDesignSvg__Lorg_apache_jena_ontology_OntModel_2(JNIEnv* env, jclass, jobject ontModel);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    setAnalysisCacheDirectory
+	 * Signature: (Ljava/lang/String;)V
+	 */
+	JNIEXPORT void JNICALL Java_com_shengjie_Main_setAnalysisCacheDirectory(JNIEnv* env, jclass, jstring directory);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    setArcTolerance
+	 * Signature: (F)V
+	 */
+	JNIEXPORT void JNICALL Java_com_shengjie_Main_setArcTolerance(JNIEnv* env, jclass, jfloat tolerance);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    setParallelRendering
+	 * Signature: (Z)V
+	 */
+	JNIEXPORT void JNICALL Java_com_shengjie_Main_setParallelRendering(JNIEnv* env, jclass, jboolean isParallel);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    setSegmentationBackend
+	 * Signature: (I)V
+	 */
+	JNIEXPORT void JNICALL Java_com_shengjie_Main_setSegmentationBackend(JNIEnv* env, jclass, jint backend);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    writeRpdDesignImage
+	 * Signature: (Lorg/apache/jena/ontology/OntModel;[BLjava/nio/ByteBuffer;II)I
+	 */
+	JNIEXPORT jint JNICALL Java_com_shengjie_Main_writeRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2_3BLjava_nio_ByteBuffer_2II(JNIEnv* env, jclass, jobject ontModel, jbyteArray base, jobject buffer, jint format, jint level);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    writeRpdDesignImage
+	 * Signature: (Lorg/apache/jena/ontology/OntModel;Ljava/nio/ByteBuffer;II)I
+	 */
+	JNIEXPORT jint JNICALL Java_com_shengjie_Main_writeRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2Ljava_nio_ByteBuffer_2II(JNIEnv* env, jclass, jobject ontModel, jobject buffer, jint format, jint level);
+
+	/*
+	 * Class:     com_shengjie_Main
+	 * Method:    writeRpdDesignImage
+	 * Signature: (Lorg/apache/jena/ontology/OntModel;Ljava/io/OutputStream;FIII)V
+	 */
+	JNIEXPORT void JNICALL Java_com_shengjie_Main_writeRpdDesignImage__Lorg_apache_jena_ontology_OntModel_2Ljava_io_OutputStream_2FIII(JNIEnv* env, jclass, jobject ontModel, jobject stream, jfloat scale, jint tileSide, jint format, jint level);
 #ifdef __cplusplus
 }
 #endif
@@ -4,24 +4,130 @@ import org.apache.jena.ontology.OntModel;
 import org.apache.jena.ontology.OntModelSpec;
 import org.apache.jena.rdf.model.ModelFactory;
 import org.opencv.core.Mat;
+import org.opencv.core.MatOfByte;
+import org.opencv.core.Scalar;
+import org.opencv.core.Size;
 
+import java.io.ByteArrayOutputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.Arrays;
+
+import static org.opencv.core.Core.absdiff;
+import static org.opencv.core.Core.mean;
+import static org.opencv.core.CvType.CV_8UC3;
+import static org.opencv.imgcodecs.Imgcodecs.IMREAD_GRAYSCALE;
+import static org.opencv.imgcodecs.Imgcodecs.imdecode;
+import static org.opencv.imgcodecs.Imgcodecs.imencode;
 import static org.opencv.imgcodecs.Imgcodecs.imread;
 import static org.opencv.imgcodecs.Imgcodecs.imwrite;
+import static org.opencv.imgproc.Imgproc.INTER_AREA;
+import static org.opencv.imgproc.Imgproc.resize;
 
 public class Main {
+    private static final int PNG = 0;
+
+    private static final int PGM = 1;
+
     static {
         System.loadLibrary("RpdDesignLib");
         System.loadLibrary("opencv_java320");
     }
 
+    public static native long[] getCurveCacheStatistics();
+
     public static native Mat getRpdDesign(OntModel ontModel, Mat mat);
 
     public static native Mat getRpdDesign(OntModel ontModel);
 
-    public static void main(String[] args) {
+    public static native byte[] getRpdDesignImage(OntModel ontModel, byte[] base, int format, int level);
+
+    public static native byte[] getRpdDesignImage(OntModel ontModel, int format, int level);
+
+    public static native String getRpdDesignSvg(OntModel ontModel, Mat mat);
+
+    public static native String getRpdDesignSvg(OntModel ontModel);
+
+    public static native void setAnalysisCacheDirectory(String directory);
+
+    public static native void setArcTolerance(float tolerance);
+
+    public static native void setParallelRendering(boolean isParallel);
+
+    public static native void setSegmentationBackend(int backend);
+
+    public static native int writeRpdDesignImage(OntModel ontModel, byte[] base, ByteBuffer buffer, int format, int level);
+
+    public static native int writeRpdDesignImage(OntModel ontModel, ByteBuffer buffer, int format, int level);
+
+    public static native void writeRpdDesignImage(OntModel ontModel, OutputStream stream, float scale, int tileSide, int format, int level);
+
+    private static byte[] getRpdDesignImage(OntModel ontModel, float scale, int tileSide, int format, int level) {
+        ByteArrayOutputStream stream = new ByteArrayOutputStream();
+        writeRpdDesignImage(ontModel, stream, scale, tileSide, format, level);
+        return stream.toByteArray();
+    }
+
+    public static void main(String[] args) throws IOException {
         OntModel ontModel = ModelFactory.createOntologyModel(OntModelSpec.OWL_DL_MEM);
         ontModel.read("../sample/sample.owl");
         imwrite("design_with_base.png", getRpdDesign(ontModel, imread("../sample/base.png")));
         imwrite("design.png", getRpdDesign(ontModel));
+        long start = System.nanoTime();
+        byte[] design = getRpdDesignImage(ontModel, PGM, 0);
+        long serialTime = System.nanoTime() - start;
+        setParallelRendering(true);
+        start = System.nanoTime();
+        byte[] parallelDesign = getRpdDesignImage(ontModel, PGM, 0);
+        long parallelTime = System.nanoTime() - start;
+        setParallelRendering(false);
+        System.out.printf("Serial rendering: %.1f ms, parallel rendering: %.1f ms%n", serialTime / 1e6, parallelTime / 1e6);
+        if (!Arrays.equals(parallelDesign, design))
+            throw new AssertionError("Parallel design differs from the serially drawn one");
+        if (!Arrays.equals(getRpdDesignImage(ontModel, 1, 0, PGM, 0), design))
+            throw new AssertionError("Replayed design differs from the directly drawn one");
+        try (OutputStream stream = new FileOutputStream("design_print.pgm")) {
+            writeRpdDesignImage(ontModel, stream, 2, 256, PGM, 0);
+        }
+        byte[] printDesign = Files.readAllBytes(Paths.get("design_print.pgm"));
+        if (!Arrays.equals(printDesign, getRpdDesignImage(ontModel, 2, 0, PGM, 0)))
+            throw new AssertionError("Tiled print design differs from the untiled one");
+        Mat designMat = imdecode(new MatOfByte(design), IMREAD_GRAYSCALE), printDesignMat = imdecode(new MatOfByte(printDesign), IMREAD_GRAYSCALE);
+        if (!printDesignMat.size().equals(new Size(designMat.cols() * 2, designMat.rows() * 2)))
+            throw new AssertionError("Print design is not twice the size of the design");
+        Mat difference = new Mat();
+        resize(printDesignMat, difference, designMat.size(), 0, 0, INTER_AREA);
+        absdiff(designMat, difference, difference);
+        if (mean(difference).val[0] > (255 - mean(designMat).val[0]) / 10)
+            throw new AssertionError("Print design does not match the design scaled down");
+        int size = -writeRpdDesignImage(ontModel, ByteBuffer.allocateDirect(1), PGM, 0);
+        if (writeRpdDesignImage(ontModel, ByteBuffer.allocateDirect(size), PGM, 0) != size)
+            throw new AssertionError("Design image does not fit the size reported for it");
+        try {
+            getRpdDesignImage(ontModel, -1, 0);
+            throw new AssertionError("Unknown image format was accepted");
+        } catch (IllegalArgumentException e) {
+        }
+        try {
+            getRpdDesignImage(ontModel, 2, 256, PNG, 0);
+            throw new AssertionError("Tiled PNG was accepted");
+        } catch (IllegalArgumentException e) {
+        }
+        try {
+            setSegmentationBackend(2);
+            throw new AssertionError("Unknown segmentation backend was accepted");
+        } catch (IllegalArgumentException e) {
+        }
+        MatOfByte blankBase = new MatOfByte();
+        imencode(".png", new Mat(600, 800, CV_8UC3, Scalar.all(255)), blankBase);
+        try {
+            getRpdDesignImage(ontModel, blankBase.toArray(), PGM, 0);
+            throw new AssertionError("Base image without teeth was accepted");
+        } catch (IllegalArgumentException e) {
+        }
     }
 }